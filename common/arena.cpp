@@ -0,0 +1,114 @@
+#include <cJSON.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_memory_utils.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "main.h"
+
+// Time between two heap checks
+#define HEAP_MONITOR_INTERVAL_MS 60000
+// mbedTLS needs blocks this large for the DTLS handshake records
+#define HEAP_MIN_LARGEST_BLOCK (16 * 1024)
+// Share of the free internal heap that is unusable for a single allocation
+#define HEAP_MAX_FRAGMENTATION_PERCENT 50
+
+// A block taken from the heap once at boot and handed out front to back.
+// Nothing is ever returned, so buffers that live as long as the device never
+// interleave with the allocations that come and go around them.
+struct pipecat_arena {
+  const char *name;
+  uint8_t *base;
+  size_t size;
+  size_t used;
+};
+
+pipecat_arena_t *pipecat_arena_create(const char *name, size_t size,
+                                      uint32_t caps) {
+  pipecat_arena_t *arena =
+      (pipecat_arena_t *)calloc(1, sizeof(pipecat_arena_t));
+  if (arena == NULL) {
+    return NULL;
+  }
+
+  arena->name = name;
+  arena->size = PIPECAT_ARENA_ALIGN(size);
+  arena->base = (uint8_t *)heap_caps_aligned_alloc(PIPECAT_ARENA_ALIGNMENT,
+                                                   arena->size, caps);
+  if (arena->base == NULL) {
+    ESP_LOGE(LOG_TAG, "Unable to allocate the %s arena (%u bytes)", name,
+             (unsigned)arena->size);
+    free(arena);
+    return NULL;
+  }
+
+  ESP_LOGI(LOG_TAG, "Arena %s: %u bytes in %s RAM", name,
+           (unsigned)arena->size,
+           esp_ptr_external_ram(arena->base) ? "external" : "internal");
+  return arena;
+}
+
+void *pipecat_arena_alloc(pipecat_arena_t *arena, size_t size) {
+  if (arena == NULL) {
+    return NULL;
+  }
+
+  size = PIPECAT_ARENA_ALIGN(size);
+  if (size > arena->size - arena->used) {
+    ESP_LOGE(LOG_TAG, "Arena %s exhausted: %u of %u bytes used, %u requested",
+             arena->name, (unsigned)arena->used, (unsigned)arena->size,
+             (unsigned)size);
+    return NULL;
+  }
+
+  void *block = arena->base + arena->used;
+  arena->used += size;
+  return block;
+}
+
+// cJSON builds and drops a tree for every RTVI message. Prefer PSRAM so that
+// this churn stays away from the internal heap the DTLS stack depends on.
+static void *json_malloc(size_t size) {
+  return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM,
+                                 MALLOC_CAP_DEFAULT);
+}
+
+void pipecat_heap_init() {
+  cJSON_Hooks hooks = {
+      .malloc_fn = json_malloc,
+      .free_fn = free,
+  };
+  cJSON_InitHooks(&hooks);
+}
+
+// Checks the internal heap every HEAP_MONITOR_INTERVAL_MS and warns once its
+// largest free block gets too small for a handshake or most of its free
+// memory is in pieces. Called from the main loop.
+void pipecat_heap_monitor() {
+  static TickType_t last_check = 0;
+  static size_t lowest_largest = SIZE_MAX;
+
+  TickType_t now = xTaskGetTickCount();
+  if (now - last_check < pdMS_TO_TICKS(HEAP_MONITOR_INTERVAL_MS)) {
+    return;
+  }
+  last_check = now;
+
+  size_t free_size = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+  int fragmentation =
+      free_size == 0 ? 0 : 100 - (int)(largest * 100 / free_size);
+  bool worse = largest < lowest_largest;
+  lowest_largest = worse ? largest : lowest_largest;
+
+  if (worse && (largest < HEAP_MIN_LARGEST_BLOCK ||
+                fragmentation > HEAP_MAX_FRAGMENTATION_PERCENT)) {
+    ESP_LOGW(LOG_TAG,
+             "Internal heap fragmented: %u free, largest block %u (%d%%)",
+             (unsigned)free_size, (unsigned)largest, fragmentation);
+  } else {
+    ESP_LOGD(LOG_TAG, "Internal heap: %u free, largest block %u (%d%%)",
+             (unsigned)free_size, (unsigned)largest, fragmentation);
+  }
+}
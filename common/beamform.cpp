@@ -0,0 +1,37 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "main.h"
+
+// Samples the second microphone is delayed by before summing, which steers
+// the beam towards a source off the array's broadside. 0 listens straight
+// ahead.
+#ifndef BEAMFORM_DELAY_SAMPLES
+#define BEAMFORM_DELAY_SAMPLES 0
+#endif
+
+#if BEAMFORM_DELAY_SAMPLES > 0
+static int16_t delay_line[BEAMFORM_DELAY_SAMPLES];
+static size_t delay_index = 0;
+#endif
+
+// Delay-and-sum of two microphones from an interleaved multi-channel capture.
+// Speech from the steered direction adds coherently while uncorrelated noise
+// doesn't, which gains up to 3 dB of SNR with two microphones.
+void PIPECAT_AUDIO_IRAM pipecat_beamform(const int16_t *capture,
+                                         size_t samples, int channels,
+                                         int mic_a, int mic_b, int16_t *out) {
+  for (size_t n = 0; n < samples; n++) {
+    const int16_t *frame = capture + n * channels;
+    int32_t b = frame[mic_b];
+#if BEAMFORM_DELAY_SAMPLES > 0
+    int16_t delayed = delay_line[delay_index];
+    delay_line[delay_index] = b;
+    if (++delay_index == BEAMFORM_DELAY_SAMPLES) {
+      delay_index = 0;
+    }
+    b = delayed;
+#endif
+    out[n] = (frame[mic_a] + b) >> 1;
+  }
+}
@@ -0,0 +1,152 @@
+#include <esp_log.h>
+#include <inttypes.h>
+#include <srtp2/srtp.h>
+#include <string.h>
+
+#include "main.h"
+
+#ifdef LINUX_BUILD
+#include <time.h>
+
+// The software fallback: mbedTLS or libsrtp's own ciphers on the host CPU
+#define BENCHMARK_CRYPTO_BACKEND "Linux, software"
+#define BENCHMARK_UNIT "ns"
+#define BENCHMARK_TICKS_PER_SECOND 1000000000ull
+static uint64_t benchmark_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+static uint32_t benchmark_since(uint64_t start) {
+  return benchmark_now() - start;
+}
+#else
+#include <esp_cpu.h>
+#include <sdkconfig.h>
+
+// SRTP_CRYPTO_MBEDTLS is set by pipecat.cmake when the srtp component
+// builds libsrtp's mbedTLS ciphers. Otherwise libsrtp runs its own AES and
+// SHA-1, whatever the mbedTLS accelerator settings.
+#if defined(SRTP_CRYPTO_MBEDTLS) && defined(CONFIG_MBEDTLS_HARDWARE_AES) && \
+    defined(CONFIG_MBEDTLS_HARDWARE_SHA)
+#define BENCHMARK_CRYPTO_BACKEND "mbedTLS, hardware AES/SHA"
+#elif defined(SRTP_CRYPTO_MBEDTLS)
+#define BENCHMARK_CRYPTO_BACKEND "mbedTLS, software"
+#else
+#define BENCHMARK_CRYPTO_BACKEND "libsrtp built-in, software"
+#endif
+#define BENCHMARK_UNIT "cycles"
+#define BENCHMARK_TICKS_PER_SECOND (CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000)
+static uint64_t benchmark_now() { return esp_cpu_get_cycle_count(); }
+static uint32_t benchmark_since(uint64_t start) {
+  return (uint32_t)(esp_cpu_get_cycle_count() - (uint32_t)start);
+}
+#endif
+
+#define BENCHMARK_PACKETS 2000
+// A 20 ms Opus frame at the encoder bitrate, plus the RTP header.
+#define BENCHMARK_RTP_HEADER_SIZE 12
+#define BENCHMARK_PAYLOAD_SIZE 80
+#define BENCHMARK_PACKET_SIZE                          \
+  (BENCHMARK_RTP_HEADER_SIZE + BENCHMARK_PAYLOAD_SIZE + \
+   SRTP_MAX_TRAILER_LEN)
+#define BENCHMARK_SSRC 0x12345678
+
+static void benchmark_fill_rtp(uint8_t *packet, uint16_t seq) {
+  uint32_t timestamp = seq * 960;
+
+  packet[0] = 0x80;
+  packet[1] = 111;
+  packet[2] = seq >> 8;
+  packet[3] = seq;
+  packet[4] = timestamp >> 24;
+  packet[5] = timestamp >> 16;
+  packet[6] = timestamp >> 8;
+  packet[7] = timestamp;
+  packet[8] = (BENCHMARK_SSRC >> 24) & 0xFF;
+  packet[9] = (BENCHMARK_SSRC >> 16) & 0xFF;
+  packet[10] = (BENCHMARK_SSRC >> 8) & 0xFF;
+  packet[11] = BENCHMARK_SSRC & 0xFF;
+  memset(packet + BENCHMARK_RTP_HEADER_SIZE, seq, BENCHMARK_PAYLOAD_SIZE);
+}
+
+static srtp_t benchmark_create_session(uint8_t *key, srtp_ssrc_type_t type) {
+  // Same protection profile libpeer negotiates for the DTLS-SRTP session.
+  srtp_policy_t policy;
+  memset(&policy, 0, sizeof(policy));
+  srtp_crypto_policy_set_rtp_default(&policy.rtp);
+  srtp_crypto_policy_set_rtcp_default(&policy.rtcp);
+  policy.ssrc.type = type;
+  policy.key = key;
+
+  srtp_t session = NULL;
+  if (srtp_create(&session, &policy) != srtp_err_status_ok) {
+    return NULL;
+  }
+  return session;
+}
+
+// Protects and unprotects BENCHMARK_PACKETS Opus sized RTP packets and logs
+// the cost of each direction. Whether mbedTLS uses the accelerators is a
+// build setting, so compare two builds to see the difference. The Linux build
+// measures the software fallback.
+void pipecat_benchmark_crypto() {
+  uint8_t key[SRTP_AES_ICM_128_KEY_LEN_WSALT];
+  for (size_t i = 0; i < sizeof(key); ++i) {
+    key[i] = i;
+  }
+
+  srtp_t sender = benchmark_create_session(key, ssrc_any_outbound);
+  srtp_t receiver = benchmark_create_session(key, ssrc_any_inbound);
+  if (sender == NULL || receiver == NULL) {
+    ESP_LOGE(LOG_TAG, "Unable to create SRTP sessions for the benchmark");
+    return;
+  }
+
+  uint8_t packet[BENCHMARK_PACKET_SIZE];
+  uint64_t protect_ticks = 0;
+  uint64_t unprotect_ticks = 0;
+  bool failed = false;
+  for (int i = 0; i < BENCHMARK_PACKETS && !failed; ++i) {
+    benchmark_fill_rtp(packet, i);
+    int len = BENCHMARK_RTP_HEADER_SIZE + BENCHMARK_PAYLOAD_SIZE;
+
+    uint64_t start = benchmark_now();
+    srtp_err_status_t protect_status = srtp_protect(sender, packet, &len);
+    uint32_t protect = benchmark_since(start);
+    start = benchmark_now();
+    srtp_err_status_t unprotect_status = srtp_unprotect(receiver, packet, &len);
+    uint32_t unprotect = benchmark_since(start);
+
+    if (protect_status != srtp_err_status_ok ||
+        unprotect_status != srtp_err_status_ok) {
+      ESP_LOGE(LOG_TAG, "SRTP benchmark failed at packet %d (%d/%d)", i,
+               protect_status, unprotect_status);
+      failed = true;
+    }
+    protect_ticks += protect;
+    unprotect_ticks += unprotect;
+  }
+
+  srtp_dealloc(sender);
+  srtp_dealloc(receiver);
+  if (failed) {
+    return;
+  }
+
+  uint32_t protect_per_packet = protect_ticks / BENCHMARK_PACKETS;
+  uint32_t unprotect_per_packet = unprotect_ticks / BENCHMARK_PACKETS;
+  if (protect_per_packet == 0 || unprotect_per_packet == 0) {
+    return;
+  }
+  ESP_LOGI(LOG_TAG,
+           "SRTP benchmark (%s, %d byte payload): protect %" PRIu32
+           " " BENCHMARK_UNIT "/packet (%" PRIu32
+           " packets/s), unprotect %" PRIu32 " " BENCHMARK_UNIT
+           "/packet (%" PRIu32 " packets/s)",
+           BENCHMARK_CRYPTO_BACKEND, BENCHMARK_PAYLOAD_SIZE,
+           protect_per_packet,
+           (uint32_t)(BENCHMARK_TICKS_PER_SECOND / protect_per_packet),
+           unprotect_per_packet,
+           (uint32_t)(BENCHMARK_TICKS_PER_SECOND / unprotect_per_packet));
+}
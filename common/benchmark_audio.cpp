@@ -0,0 +1,223 @@
+#include <esp_log.h>
+#include <inttypes.h>
+#include <math.h>
+#include <opus.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "main.h"
+
+#ifdef LINUX_BUILD
+#include <time.h>
+
+#define BENCHMARK_UNIT "ns"
+static uint64_t benchmark_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+static uint64_t benchmark_since(uint64_t start) {
+  return benchmark_now() - start;
+}
+#else
+#include <esp_cpu.h>
+
+#define BENCHMARK_UNIT "cycles"
+static uint64_t benchmark_now() { return esp_cpu_get_cycle_count(); }
+// The cycle counter is 32 bits wide and wraps every ~18 s at 240 MHz.
+static uint64_t benchmark_since(uint64_t start) {
+  return (uint32_t)(esp_cpu_get_cycle_count() - (uint32_t)start);
+}
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#include <esp32s3/rom/cache.h>
+#define BENCHMARK_COLD_CACHE 1
+#endif
+#endif
+
+#define BENCHMARK_FRAMES 500
+#define BENCHMARK_TONE_HZ 440
+// Opus frames are encoded and decoded at the codec rate of every board
+#define BENCHMARK_OPUS_RATE 16000
+#define BENCHMARK_OPUS_BITRATE 30000
+#define BENCHMARK_OPUS_BUFFER_SIZE 1276
+
+static const int BENCHMARK_RATES[] = {16000, 24000, 48000};
+#define BENCHMARK_RATE_COUNT \
+  (int)(sizeof(BENCHMARK_RATES) / sizeof(BENCHMARK_RATES[0]))
+
+// Resamples BENCHMARK_FRAMES 20 ms frames of a tone between every pair of
+// supported rates and logs the cost per frame.
+static void benchmark_resampler() {
+  for (int i = 0; i < BENCHMARK_RATE_COUNT; i++) {
+    for (int o = 0; o < BENCHMARK_RATE_COUNT; o++) {
+      int in_rate = BENCHMARK_RATES[i];
+      int out_rate = BENCHMARK_RATES[o];
+      if (in_rate == out_rate) {
+        continue;
+      }
+
+      size_t in_samples = in_rate / 50;
+      size_t out_samples = out_rate / 50;
+      int16_t *in = (int16_t *)malloc(in_samples * sizeof(int16_t));
+      int16_t *out = (int16_t *)malloc(out_samples * sizeof(int16_t));
+      pipecat_resampler_t *resampler = pipecat_resampler_create(
+          in_rate, out_rate, RESAMPLER_TAPS, in_samples);
+      if (in == NULL || out == NULL || resampler == NULL) {
+        ESP_LOGE(LOG_TAG, "Unable to set up the resampler benchmark");
+        pipecat_resampler_destroy(resampler);
+        free(in);
+        free(out);
+        return;
+      }
+
+      uint64_t total = 0;
+      size_t produced = 0;
+      for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+        for (size_t n = 0; n < in_samples; n++) {
+          double t = (double)(frame * in_samples + n) / in_rate;
+          in[n] = (int16_t)(16384 * sin(2 * M_PI * BENCHMARK_TONE_HZ * t));
+        }
+
+        uint64_t start = benchmark_now();
+        produced += pipecat_resampler_process(resampler, in, in_samples, out);
+        total += benchmark_since(start);
+      }
+
+      ESP_LOGI(LOG_TAG,
+               "Resampler benchmark %d -> %d Hz (%d taps): %" PRIu64
+               " " BENCHMARK_UNIT "/frame, %zu/%zu samples",
+               in_rate, out_rate, RESAMPLER_TAPS, total / BENCHMARK_FRAMES,
+               produced, out_samples * BENCHMARK_FRAMES);
+      pipecat_resampler_destroy(resampler);
+      free(in);
+      free(out);
+    }
+  }
+}
+
+// Runs the playback limiter over a tone that alternates between quiet and
+// full scale every second and logs the cost per frame along with the loudest
+// output sample, which has to stay below the limiter's ceiling.
+static void benchmark_limiter() {
+  for (int r = 0; r < BENCHMARK_RATE_COUNT; r++) {
+    int rate = BENCHMARK_RATES[r];
+    size_t samples = rate / 50;
+    int16_t *pcm = (int16_t *)malloc(samples * sizeof(int16_t));
+    pipecat_limiter_t *limiter = pipecat_limiter_create(rate, samples);
+    if (pcm == NULL || limiter == NULL) {
+      ESP_LOGE(LOG_TAG, "Unable to set up the limiter benchmark");
+      pipecat_limiter_destroy(limiter);
+      free(pcm);
+      return;
+    }
+
+    uint64_t total = 0;
+    int peak = 0;
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+      double amplitude = (frame / 50) % 2 == 0 ? 1000 : 32767;
+      for (size_t n = 0; n < samples; n++) {
+        double t = (double)(frame * samples + n) / rate;
+        pcm[n] = (int16_t)(amplitude * sin(2 * M_PI * BENCHMARK_TONE_HZ * t));
+      }
+
+      uint64_t start = benchmark_now();
+      pipecat_limiter_process(limiter, pcm, samples);
+      total += benchmark_since(start);
+
+      for (size_t n = 0; n < samples; n++) {
+        peak = abs(pcm[n]) > peak ? abs(pcm[n]) : peak;
+      }
+    }
+
+    ESP_LOGI(LOG_TAG,
+             "Limiter benchmark %d Hz: %" PRIu64 " " BENCHMARK_UNIT
+             "/frame, output peak %d",
+             rate, total / BENCHMARK_FRAMES, peak);
+    pipecat_limiter_destroy(limiter);
+    free(pcm);
+  }
+}
+
+// Encodes and decodes BENCHMARK_FRAMES 20 ms frames of voice-like audio and
+// logs the average and worst cost of a frame. On the ESP32-S3 the run is
+// repeated with the instruction cache invalidated before every frame, the
+// worst case when Wi-Fi or the display evicted the audio path. Compare a
+// build with and without AUDIO_IRAM.
+static void benchmark_opus(bool cold_cache) {
+  const int samples = BENCHMARK_OPUS_RATE / 50;
+  int error;
+  OpusEncoder *encoder = opus_encoder_create(
+      BENCHMARK_OPUS_RATE, 1, OPUS_APPLICATION_VOIP, &error);
+  OpusDecoder *decoder = opus_decoder_create(BENCHMARK_OPUS_RATE, 1, &error);
+  int16_t *pcm = (int16_t *)malloc(samples * sizeof(int16_t));
+  uint8_t *packet = (uint8_t *)malloc(BENCHMARK_OPUS_BUFFER_SIZE);
+  if (encoder == NULL || decoder == NULL || pcm == NULL || packet == NULL) {
+    ESP_LOGE(LOG_TAG, "Unable to set up the Opus benchmark");
+    opus_encoder_destroy(encoder);
+    opus_decoder_destroy(decoder);
+    free(pcm);
+    free(packet);
+    return;
+  }
+  opus_encoder_ctl(encoder, OPUS_SET_BITRATE(BENCHMARK_OPUS_BITRATE));
+  opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(0));
+  opus_encoder_ctl(encoder, OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE));
+
+  uint64_t total = 0;
+  uint64_t worst = 0;
+  srand(1);
+  for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+    // A tone with a syllable-rate envelope and some noise, so that the
+    // encoder doesn't settle on silence.
+    for (int n = 0; n < samples; n++) {
+      double t = (double)(frame * samples + n) / BENCHMARK_OPUS_RATE;
+      double envelope = 0.5 + 0.5 * sin(2 * M_PI * 4 * t);
+      pcm[n] = (int16_t)(8000 * envelope *
+                             sin(2 * M_PI * BENCHMARK_TONE_HZ * t) +
+                         (rand() % 1024 - 512));
+    }
+
+#ifdef BENCHMARK_COLD_CACHE
+    if (cold_cache) {
+      Cache_Invalidate_ICache_All();
+    }
+#endif
+    uint64_t start = benchmark_now();
+    int size = opus_encode(encoder, pcm, samples, packet,
+                           BENCHMARK_OPUS_BUFFER_SIZE);
+    if (size > 0) {
+      opus_decode(decoder, packet, size, pcm, samples, 0);
+    }
+    uint64_t elapsed = benchmark_since(start);
+
+    total += elapsed;
+    worst = elapsed > worst ? elapsed : worst;
+  }
+
+  ESP_LOGI(LOG_TAG,
+           "Opus benchmark (%s cache, %s): %" PRIu64 " " BENCHMARK_UNIT
+           "/frame, worst %" PRIu64,
+           cold_cache ? "cold" : "warm",
+#ifdef AUDIO_IRAM
+           "IRAM",
+#else
+           "flash",
+#endif
+           total / BENCHMARK_FRAMES, worst);
+  opus_encoder_destroy(encoder);
+  opus_decoder_destroy(decoder);
+  free(pcm);
+  free(packet);
+}
+
+// Runs on the device and in the Linux build, which reports nanoseconds
+// instead of cycles.
+void pipecat_benchmark_audio() {
+  benchmark_resampler();
+  benchmark_limiter();
+  benchmark_opus(false);
+#ifdef BENCHMARK_COLD_CACHE
+  benchmark_opus(true);
+#endif
+}
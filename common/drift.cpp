@@ -0,0 +1,84 @@
+#include <esp_log.h>
+#include <stdint.h>
+
+#include "main.h"
+
+// Frames averaged before the queue level is taken as the reference
+#define DRIFT_SETTLE_FRAMES 50
+// The queue level is smoothed over ~2^6 frames
+#define DRIFT_SMOOTHING_SHIFT 6
+// Correction per sample of queue level away from the reference
+#define DRIFT_PPM_PER_SAMPLE 1
+#define DRIFT_MAX_PPM 1000
+
+// The playback queue is filled at the rate of the sender's clock and drained
+// at the rate of the codec's I2S clock. Its low-pass filtered level is compared
+// with the level once the queue has settled, and the difference steers a
+// resampler that plays slightly faster or slower. Being proportional, the
+// controller bounds the extra latency to DRIFT_MAX_PPM / DRIFT_PPM_PER_SAMPLE
+// samples.
+static int32_t level_q8 = 0;
+static int32_t reference_q8 = 0;
+static int settle_frames = 0;
+static int32_t drift_ppm = 0;
+
+// Q32 read position, where 0 is the sample held back from the previous call
+static int64_t phase = 0;
+static int16_t last_sample = 0;
+
+void pipecat_drift_reset() {
+  settle_frames = 0;
+  drift_ppm = 0;
+  phase = 0;
+  last_sample = 0;
+}
+
+int32_t PIPECAT_AUDIO_IRAM pipecat_drift_update(int32_t queued_samples) {
+  int32_t sample_q8 = queued_samples << 8;
+  if (settle_frames == 0) {
+    level_q8 = sample_q8;
+  }
+  level_q8 += (sample_q8 - level_q8) >> DRIFT_SMOOTHING_SHIFT;
+
+  if (settle_frames < DRIFT_SETTLE_FRAMES) {
+    if (++settle_frames == DRIFT_SETTLE_FRAMES) {
+      reference_q8 = level_q8;
+      ESP_LOGD(LOG_TAG, "Playback queue settled at %ld samples",
+               (long)(reference_q8 >> 8));
+    }
+    return 0;
+  }
+
+  int32_t ppm = ((level_q8 - reference_q8) >> 8) * DRIFT_PPM_PER_SAMPLE;
+  if (ppm > DRIFT_MAX_PPM) {
+    ppm = DRIFT_MAX_PPM;
+  } else if (ppm < -DRIFT_MAX_PPM) {
+    ppm = -DRIFT_MAX_PPM;
+  }
+  drift_ppm = ppm;
+  return drift_ppm;
+}
+
+// Linear interpolation stepping 1 + drift_ppm / 10^6 input samples per output
+// sample. Returns the number of samples written to `out`, which must have room
+// for `samples` + DRIFT_RESAMPLE_SLACK.
+size_t PIPECAT_AUDIO_IRAM pipecat_drift_resample(const int16_t *in,
+                                                 size_t samples, int16_t *out) {
+  const int64_t step = (1LL << 32) + ((int64_t)drift_ppm << 32) / 1000000;
+  const int64_t end = (int64_t)samples << 32;
+
+  size_t written = 0;
+  while (phase < end) {
+    size_t i = phase >> 32;
+    int32_t a = i == 0 ? last_sample : in[i - 1];
+    int32_t b = in[i];
+    // Q15, so that (b - a) * frac stays within 32 bits.
+    int32_t frac = (phase >> 17) & 0x7FFF;
+    out[written++] = (int16_t)(a + (((b - a) * frac) >> 15));
+    phase += step;
+  }
+
+  phase -= end;
+  last_sample = in[samples - 1];
+  return written;
+}
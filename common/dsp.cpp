@@ -0,0 +1,221 @@
+#include <esp_cpu.h>
+#include <esp_log.h>
+#include <inttypes.h>
+#include <math.h>
+#include <string.h>
+
+#include "main.h"
+
+// Frames between two cost reports (10 s)
+#define DSP_REPORT_FRAMES 500
+
+// High-pass corner, removes DC and handling rumble below the voice band
+#define HIGHPASS_CUTOFF_HZ 80
+
+// Frames below the noise floor by this energy ratio are attenuated
+#define NS_SPEECH_RATIO 4
+#define NS_MIN_GAIN_Q15 8192  // -12 dB
+// The noise floor creeps up by 1/2^7 of itself per frame (~1.7 dB/s)
+#define NS_FLOOR_RISE_SHIFT 7
+#define NS_FLOOR_MIN 16
+
+// AGC aims for -18 dBFS RMS with at most 18 dB of gain
+#define AGC_TARGET_RMS 4125
+#define AGC_MAX_GAIN_Q12 (8 << 12)
+#define AGC_MIN_GAIN_Q12 (1 << 10)
+// Frames quieter than this are not speech and leave the gain alone
+#define AGC_SPEECH_RMS 200
+#define AGC_ATTACK_SHIFT 1
+#define AGC_RELEASE_SHIFT 5
+
+// Capture processing stage, runs in place on every frame between the
+// microphone and the encoder.
+typedef struct {
+  const char *name;
+  uint32_t flag;
+  void (*init)(int sample_rate);
+  void (*process)(int16_t *pcm, size_t samples);
+  bool enabled;
+  uint64_t cycles;
+} dsp_stage_t;
+
+static inline int16_t saturate(int32_t x) {
+  return x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x);
+}
+
+static uint32_t PIPECAT_AUDIO_IRAM mean_square(const int16_t *pcm,
+                                               size_t samples) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < samples; i++) {
+    sum += (int32_t)pcm[i] * pcm[i];
+  }
+  return sum / samples;
+}
+
+static uint32_t PIPECAT_AUDIO_IRAM isqrt(uint32_t x) {
+  uint32_t root = 0;
+  uint32_t bit = 1u << 30;
+  while (bit > x) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (x >= root + bit) {
+      x -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// First order high-pass: y[n] = x[n] - x[n-1] + a * y[n-1]
+static int32_t highpass_pole_q15 = 0;
+static int32_t highpass_x = 0;
+static int32_t highpass_y = 0;
+
+static void highpass_init(int sample_rate) {
+  highpass_pole_q15 =
+      (int32_t)(32768.0 * exp(-2.0 * M_PI * HIGHPASS_CUTOFF_HZ / sample_rate));
+}
+
+static void PIPECAT_AUDIO_IRAM highpass_process(int16_t *pcm, size_t samples) {
+  for (size_t i = 0; i < samples; i++) {
+    int32_t x = pcm[i];
+    highpass_y = x - highpass_x + ((highpass_pole_q15 * highpass_y) >> 15);
+    highpass_x = x;
+    pcm[i] = saturate(highpass_y);
+  }
+}
+
+// Downward expander: frames that don't rise clearly above the tracked noise
+// floor are attenuated. The gain opens at once so onsets aren't clipped and
+// closes over a few frames, ramped per sample to avoid clicks.
+static uint32_t ns_floor = NS_FLOOR_MIN;
+static int32_t ns_gain_q15 = 32767;
+
+static void noise_suppression_init(int sample_rate) {
+  ns_floor = NS_FLOOR_MIN;
+  ns_gain_q15 = 32767;
+}
+
+static void PIPECAT_AUDIO_IRAM noise_suppression_process(int16_t *pcm,
+                                                         size_t samples) {
+  uint32_t energy = mean_square(pcm, samples);
+  if (energy < ns_floor) {
+    ns_floor = energy < NS_FLOOR_MIN ? NS_FLOOR_MIN : energy;
+  } else {
+    ns_floor += (ns_floor >> NS_FLOOR_RISE_SHIFT) + 1;
+  }
+
+  int32_t target = energy > (uint64_t)ns_floor * NS_SPEECH_RATIO
+                       ? 32767
+                       : NS_MIN_GAIN_Q15;
+  int32_t gain = target > ns_gain_q15
+                     ? target
+                     : ns_gain_q15 + ((target - ns_gain_q15) >> 2);
+
+  int32_t step = (gain - ns_gain_q15) / (int32_t)samples;
+  int32_t current = ns_gain_q15;
+  for (size_t i = 0; i < samples; i++) {
+    current += step;
+    pcm[i] = (pcm[i] * current) >> 15;
+  }
+  ns_gain_q15 = gain;
+}
+
+// Brings speech to AGC_TARGET_RMS. The gain drops quickly when speech gets
+// louder, rises slowly when it gets quieter and is capped so the frame peak
+// never clips.
+static int32_t agc_gain_q12 = 1 << 12;
+
+static void agc_init(int sample_rate) { agc_gain_q12 = 1 << 12; }
+
+static void PIPECAT_AUDIO_IRAM agc_process(int16_t *pcm, size_t samples) {
+  uint32_t rms = isqrt(mean_square(pcm, samples));
+  if (rms >= AGC_SPEECH_RMS) {
+    int32_t desired = (AGC_TARGET_RMS << 12) / rms;
+    int32_t shift =
+        desired < agc_gain_q12 ? AGC_ATTACK_SHIFT : AGC_RELEASE_SHIFT;
+    agc_gain_q12 += (desired - agc_gain_q12) >> shift;
+  }
+
+  int32_t peak = 1;
+  for (size_t i = 0; i < samples; i++) {
+    int32_t magnitude = pcm[i] < 0 ? -pcm[i] : pcm[i];
+    peak = magnitude > peak ? magnitude : peak;
+  }
+  int32_t headroom = (INT16_MAX << 12) / peak;
+  if (agc_gain_q12 > headroom) {
+    agc_gain_q12 = headroom;
+  }
+  if (agc_gain_q12 > AGC_MAX_GAIN_Q12) {
+    agc_gain_q12 = AGC_MAX_GAIN_Q12;
+  } else if (agc_gain_q12 < AGC_MIN_GAIN_Q12) {
+    agc_gain_q12 = AGC_MIN_GAIN_Q12;
+  }
+
+  for (size_t i = 0; i < samples; i++) {
+    pcm[i] = saturate((pcm[i] * agc_gain_q12) >> 12);
+  }
+}
+
+static dsp_stage_t dsp_stages[] = {
+    {"high-pass", PIPECAT_DSP_HIGHPASS, highpass_init, highpass_process},
+    {"noise suppression", PIPECAT_DSP_NOISE_SUPPRESSION,
+     noise_suppression_init, noise_suppression_process},
+    {"AGC", PIPECAT_DSP_AGC, agc_init, agc_process},
+};
+#define DSP_STAGE_COUNT (sizeof(dsp_stages) / sizeof(dsp_stages[0]))
+
+static uint32_t dsp_frames = 0;
+
+void pipecat_dsp_init(int sample_rate, uint32_t stages) {
+  for (size_t i = 0; i < DSP_STAGE_COUNT; i++) {
+    dsp_stages[i].init(sample_rate);
+    dsp_stages[i].enabled = (stages & dsp_stages[i].flag) != 0;
+    dsp_stages[i].cycles = 0;
+  }
+  dsp_frames = 0;
+}
+
+void pipecat_dsp_set_enabled(uint32_t stages, bool enabled) {
+  for (size_t i = 0; i < DSP_STAGE_COUNT; i++) {
+    if (stages & dsp_stages[i].flag) {
+      dsp_stages[i].enabled = enabled;
+    }
+  }
+}
+
+void PIPECAT_AUDIO_IRAM pipecat_dsp_process(int16_t *pcm, size_t samples) {
+  for (size_t i = 0; i < DSP_STAGE_COUNT; i++) {
+    if (!dsp_stages[i].enabled) {
+      continue;
+    }
+    uint32_t start = esp_cpu_get_cycle_count();
+    dsp_stages[i].process(pcm, samples);
+    dsp_stages[i].cycles += esp_cpu_get_cycle_count() - start;
+  }
+
+  if (++dsp_frames == DSP_REPORT_FRAMES) {
+    pipecat_dsp_report();
+  }
+}
+
+// Logs the average cycles per frame of every enabled stage since the last
+// report.
+void pipecat_dsp_report() {
+  if (dsp_frames == 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < DSP_STAGE_COUNT; i++) {
+    if (dsp_stages[i].enabled) {
+      ESP_LOGD(LOG_TAG, "DSP %s: %" PRIu64 " cycles/frame",
+               dsp_stages[i].name, dsp_stages[i].cycles / dsp_frames);
+    }
+    dsp_stages[i].cycles = 0;
+  }
+  dsp_frames = 0;
+}
@@ -0,0 +1,200 @@
+#define MBEDTLS_ALLOW_PRIVATE_ACCESS
+
+#include <esp_log.h>
+#include <inttypes.h>
+#include <mbedtls/ecp.h>
+#include <mbedtls/x509_crt.h>
+#include <nvs.h>
+#include <string.h>
+
+#include "main.h"
+
+#define DTLS_NVS_NAMESPACE "dtls"
+#define DTLS_NVS_KEY "key"
+#define DTLS_NVS_CERT "cert"
+#define DTLS_NVS_USES "uses"
+#define DTLS_KEY_GROUP MBEDTLS_ECP_DP_SECP256R1
+#define DTLS_PRIVATE_KEY_LENGTH 32
+#define DTLS_PUBLIC_KEY_LENGTH 65
+#define DTLS_CERT_MAX_PEM_LENGTH 1024
+
+// Number of connections a key and certificate are used for before a new pair
+// is generated, 0 keeps them forever.
+#ifndef DTLS_CERT_MAX_USES
+#define DTLS_CERT_MAX_USES 0
+#endif
+
+// libpeer generates a new ECDSA key and self-signed certificate in
+// dtls_srtp_init for every peer connection. dtls_srtp_init,
+// mbedtls_ecp_gen_key and mbedtls_x509write_crt_pem are wrapped at link time
+// (see pipecat.cmake) so that the pair is generated once, kept in NVS and
+// handed back to libpeer on later connections. Only the key generated inside
+// dtls_srtp_init is substituted, ECDHE and everything else in the image
+// keeps fresh keys.
+typedef struct {
+  uint8_t private_key[DTLS_PRIVATE_KEY_LENGTH];
+  uint8_t public_key[DTLS_PUBLIC_KEY_LENGTH];
+} dtls_key_t;
+
+static dtls_key_t dtls_key;
+static char dtls_cert_pem[DTLS_CERT_MAX_PEM_LENGTH];
+static uint32_t dtls_uses = 0;
+static bool dtls_cached = false;
+static bool dtls_creating_cert = false;
+static bool dtls_serve_cached_cert = false;
+static bool dtls_store_pending = false;
+
+typedef int (*dtls_rng_t)(void *, unsigned char *, size_t);
+
+// libpeer's DtlsSrtp and DtlsSrtpRole, only passed through.
+extern "C" int __real_dtls_srtp_init(void *dtls_srtp, int role,
+                                     void *user_data);
+
+extern "C" int __real_mbedtls_ecp_gen_key(mbedtls_ecp_group_id grp_id,
+                                          mbedtls_ecp_keypair *key,
+                                          dtls_rng_t f_rng, void *p_rng);
+extern "C" int __real_mbedtls_x509write_crt_pem(mbedtls_x509write_cert *crt,
+                                                unsigned char *buf,
+                                                size_t size, dtls_rng_t f_rng,
+                                                void *p_rng);
+
+static void pipecat_store_dtls_certificate(const char *cert_pem) {
+  // The connection that generated the pair counts as its first use.
+  strcpy(dtls_cert_pem, cert_pem);
+  dtls_uses = 1;
+  dtls_cached = DTLS_CERT_MAX_USES != 1;
+
+  nvs_handle_t handle;
+  if (nvs_open(DTLS_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+    ESP_LOGW(LOG_TAG, "Unable to open NVS to store the DTLS certificate");
+    return;
+  }
+
+  if (nvs_set_blob(handle, DTLS_NVS_KEY, &dtls_key, sizeof(dtls_key_t)) !=
+          ESP_OK ||
+      nvs_set_str(handle, DTLS_NVS_CERT, cert_pem) != ESP_OK ||
+      nvs_set_u32(handle, DTLS_NVS_USES, 1) != ESP_OK ||
+      nvs_commit(handle) != ESP_OK) {
+    ESP_LOGW(LOG_TAG, "Unable to store the DTLS certificate");
+  } else {
+    ESP_LOGI(LOG_TAG, "Stored new DTLS certificate");
+  }
+  nvs_close(handle);
+}
+
+// Counts a connection served the cached pair. Without rotation there is
+// nothing to count, spare the flash writes.
+static void pipecat_count_dtls_certificate_use() {
+  if (DTLS_CERT_MAX_USES == 0) {
+    return;
+  }
+  dtls_uses++;
+  if (dtls_uses >= DTLS_CERT_MAX_USES) {
+    dtls_cached = false;
+  }
+
+  nvs_handle_t handle;
+  if (nvs_open(DTLS_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+    return;
+  }
+  nvs_set_u32(handle, DTLS_NVS_USES, dtls_uses);
+  nvs_commit(handle);
+  nvs_close(handle);
+}
+
+void pipecat_init_dtls_certificate() {
+  nvs_handle_t handle;
+  if (nvs_open(DTLS_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+    return;
+  }
+
+  size_t key_size = sizeof(dtls_key_t);
+  size_t cert_size = sizeof(dtls_cert_pem);
+  if (nvs_get_blob(handle, DTLS_NVS_KEY, &dtls_key, &key_size) != ESP_OK ||
+      key_size != sizeof(dtls_key_t) ||
+      nvs_get_str(handle, DTLS_NVS_CERT, dtls_cert_pem, &cert_size) !=
+          ESP_OK) {
+    nvs_close(handle);
+    return;
+  }
+
+  nvs_get_u32(handle, DTLS_NVS_USES, &dtls_uses);
+  nvs_close(handle);
+  if (DTLS_CERT_MAX_USES > 0 && dtls_uses >= DTLS_CERT_MAX_USES) {
+    ESP_LOGI(LOG_TAG, "Rotating DTLS certificate after %" PRIu32 " uses",
+             dtls_uses);
+  } else {
+    dtls_cached = true;
+  }
+}
+
+extern "C" int __wrap_dtls_srtp_init(void *dtls_srtp, int role,
+                                     void *user_data) {
+  dtls_creating_cert = true;
+  int ret = __real_dtls_srtp_init(dtls_srtp, role, user_data);
+  dtls_creating_cert = false;
+  dtls_serve_cached_cert = false;
+  dtls_store_pending = false;
+  return ret;
+}
+
+extern "C" int __wrap_mbedtls_ecp_gen_key(mbedtls_ecp_group_id grp_id,
+                                          mbedtls_ecp_keypair *key,
+                                          dtls_rng_t f_rng, void *p_rng) {
+  if (!dtls_creating_cert || grp_id != DTLS_KEY_GROUP) {
+    return __real_mbedtls_ecp_gen_key(grp_id, key, f_rng, p_rng);
+  }
+  // libpeer generates a single key per connection.
+  dtls_creating_cert = false;
+
+  if (dtls_cached) {
+    if (mbedtls_ecp_group_load(&key->grp, grp_id) == 0 &&
+        mbedtls_mpi_read_binary(&key->d, dtls_key.private_key,
+                                sizeof(dtls_key.private_key)) == 0 &&
+        mbedtls_ecp_point_read_binary(&key->grp, &key->Q, dtls_key.public_key,
+                                      sizeof(dtls_key.public_key)) == 0) {
+      dtls_serve_cached_cert = true;
+      pipecat_count_dtls_certificate_use();
+      return 0;
+    }
+    ESP_LOGW(LOG_TAG, "Stored DTLS key is invalid, generating a new one");
+    dtls_cached = false;
+  }
+
+  int ret = __real_mbedtls_ecp_gen_key(grp_id, key, f_rng, p_rng);
+
+  size_t public_key_len = 0;
+  dtls_serve_cached_cert = false;
+  dtls_store_pending =
+      ret == 0 &&
+      mbedtls_mpi_write_binary(&key->d, dtls_key.private_key,
+                               sizeof(dtls_key.private_key)) == 0 &&
+      mbedtls_ecp_point_write_binary(
+          &key->grp, &key->Q, MBEDTLS_ECP_PF_UNCOMPRESSED, &public_key_len,
+          dtls_key.public_key, sizeof(dtls_key.public_key)) == 0 &&
+      public_key_len == sizeof(dtls_key.public_key);
+  return ret;
+}
+
+extern "C" int __wrap_mbedtls_x509write_crt_pem(mbedtls_x509write_cert *crt,
+                                                unsigned char *buf,
+                                                size_t size, dtls_rng_t f_rng,
+                                                void *p_rng) {
+  if (dtls_serve_cached_cert) {
+    dtls_serve_cached_cert = false;
+    size_t len = strlen(dtls_cert_pem) + 1;
+    if (len <= size) {
+      memcpy(buf, dtls_cert_pem, len);
+      return 0;
+    }
+  }
+
+  int ret = __real_mbedtls_x509write_crt_pem(crt, buf, size, f_rng, p_rng);
+  if (ret == 0 && dtls_store_pending) {
+    dtls_store_pending = false;
+    if (strlen((const char *)buf) < sizeof(dtls_cert_pem)) {
+      pipecat_store_dtls_certificate((const char *)buf);
+    }
+  }
+  return ret;
+}
@@ -0,0 +1,390 @@
+#include <esp_http_client.h>
+#include <esp_log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#define HTTP_CHUNK_SIZE 512
+#define HTTP_MAX_REDIRECTS 3
+#define JSON_MAX_ESCAPE_LENGTH 6
+
+static const char OFFER_PREFIX[] = "{\"sdp\":\"";
+static const char OFFER_SUFFIX[] = "\",\"type\":\"offer\"}";
+static const char SDP_KEY[] = "sdp";
+
+// Incremental extractor for the top-level `sdp` string of the answer. The
+// response is fed in whatever pieces the HTTP client returns and only the
+// unescaped SDP is kept, no JSON document is ever built.
+typedef struct {
+  int depth;
+  bool in_string;
+  bool escape;
+  bool expect_key;
+  bool in_key;
+  size_t key_len;
+  bool key_matches;
+  bool sdp_key;
+  bool sdp_value;
+  bool capturing;
+  int unicode_digits;
+  uint32_t unicode_value;
+  char *sdp;
+  size_t sdp_len;
+  size_t sdp_capacity;
+  bool done;
+  bool error;
+} sdp_scanner_t;
+
+static size_t json_escape_char(char c, char *out) {
+  switch (c) {
+    case '"':
+    case '\\':
+      out[0] = '\\';
+      out[1] = c;
+      return 2;
+    case '\n':
+      out[0] = '\\';
+      out[1] = 'n';
+      return 2;
+    case '\r':
+      out[0] = '\\';
+      out[1] = 'r';
+      return 2;
+    case '\t':
+      out[0] = '\\';
+      out[1] = 't';
+      return 2;
+    default:
+      if ((unsigned char)c < 0x20) {
+        snprintf(out, JSON_MAX_ESCAPE_LENGTH + 1, "\\u%04x", c);
+        return JSON_MAX_ESCAPE_LENGTH;
+      }
+      out[0] = c;
+      return 1;
+  }
+}
+
+static size_t json_escaped_length(const char *text) {
+  char escaped[JSON_MAX_ESCAPE_LENGTH + 1];
+  size_t len = 0;
+  for (; *text; ++text) {
+    len += json_escape_char(*text, escaped);
+  }
+  return len;
+}
+
+static bool http_write_all(esp_http_client_handle_t client, const char *data,
+                           size_t len) {
+  while (len > 0) {
+    int written = esp_http_client_write(client, data, len);
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    len -= written;
+  }
+  return true;
+}
+
+// Streams `{"sdp":"<offer>","type":"offer"}`, escaping the offer on the fly.
+static bool http_write_offer(esp_http_client_handle_t client,
+                             const char *offer) {
+  char chunk[HTTP_CHUNK_SIZE];
+  size_t used = 0;
+
+  if (!http_write_all(client, OFFER_PREFIX, strlen(OFFER_PREFIX))) {
+    return false;
+  }
+
+  for (; *offer; ++offer) {
+    if (used + JSON_MAX_ESCAPE_LENGTH + 1 > sizeof(chunk)) {
+      if (!http_write_all(client, chunk, used)) {
+        return false;
+      }
+      used = 0;
+    }
+    used += json_escape_char(*offer, chunk + used);
+  }
+
+  return http_write_all(client, chunk, used) &&
+         http_write_all(client, OFFER_SUFFIX, strlen(OFFER_SUFFIX));
+}
+
+static void sdp_scanner_append(sdp_scanner_t *scanner, const char *data,
+                               size_t len) {
+  if (scanner->sdp_len + len + 1 > scanner->sdp_capacity) {
+    size_t capacity = scanner->sdp_capacity;
+    while (scanner->sdp_len + len + 1 > capacity) {
+      capacity *= 2;
+    }
+
+    char *sdp = (char *)realloc(scanner->sdp, capacity);
+    if (sdp == NULL) {
+      ESP_LOGE(LOG_TAG, "Unable to grow SDP answer to %d bytes",
+               (int)capacity);
+      scanner->error = true;
+      return;
+    }
+    scanner->sdp = sdp;
+    scanner->sdp_capacity = capacity;
+  }
+
+  memcpy(scanner->sdp + scanner->sdp_len, data, len);
+  scanner->sdp_len += len;
+  scanner->sdp[scanner->sdp_len] = '\0';
+}
+
+static void sdp_scanner_append_codepoint(sdp_scanner_t *scanner,
+                                         uint32_t codepoint) {
+  char utf8[3];
+  if (codepoint < 0x80) {
+    utf8[0] = codepoint;
+    sdp_scanner_append(scanner, utf8, 1);
+  } else if (codepoint < 0x800) {
+    utf8[0] = 0xC0 | (codepoint >> 6);
+    utf8[1] = 0x80 | (codepoint & 0x3F);
+    sdp_scanner_append(scanner, utf8, 2);
+  } else {
+    utf8[0] = 0xE0 | (codepoint >> 12);
+    utf8[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+    utf8[2] = 0x80 | (codepoint & 0x3F);
+    sdp_scanner_append(scanner, utf8, 3);
+  }
+}
+
+static void sdp_scanner_string_char(sdp_scanner_t *scanner, char c) {
+  if (scanner->capturing) {
+    sdp_scanner_append(scanner, &c, 1);
+  } else if (scanner->in_key) {
+    scanner->key_matches = scanner->key_matches &&
+                           scanner->key_len < strlen(SDP_KEY) &&
+                           SDP_KEY[scanner->key_len] == c;
+    scanner->key_len++;
+  }
+}
+
+static void sdp_scanner_escape(sdp_scanner_t *scanner, char c) {
+  switch (c) {
+    case 'n':
+      sdp_scanner_string_char(scanner, '\n');
+      break;
+    case 'r':
+      sdp_scanner_string_char(scanner, '\r');
+      break;
+    case 't':
+      sdp_scanner_string_char(scanner, '\t');
+      break;
+    case 'b':
+      sdp_scanner_string_char(scanner, '\b');
+      break;
+    case 'f':
+      sdp_scanner_string_char(scanner, '\f');
+      break;
+    case 'u':
+      scanner->unicode_digits = 4;
+      scanner->unicode_value = 0;
+      break;
+    default:
+      sdp_scanner_string_char(scanner, c);
+      break;
+  }
+}
+
+static void sdp_scanner_unicode_digit(sdp_scanner_t *scanner, char c) {
+  uint32_t digit;
+  if (c >= '0' && c <= '9') {
+    digit = c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    digit = c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    digit = c - 'A' + 10;
+  } else {
+    scanner->error = true;
+    return;
+  }
+
+  scanner->unicode_value = (scanner->unicode_value << 4) | digit;
+  if (--scanner->unicode_digits > 0) {
+    return;
+  }
+
+  if (scanner->capturing) {
+    sdp_scanner_append_codepoint(scanner, scanner->unicode_value);
+  } else if (scanner->in_key) {
+    // Keys are only compared against "sdp", anything escaped never matches.
+    scanner->key_matches = false;
+    scanner->key_len++;
+  }
+}
+
+static void sdp_scanner_end_string(sdp_scanner_t *scanner) {
+  scanner->in_string = false;
+  if (scanner->capturing) {
+    scanner->capturing = false;
+    scanner->done = true;
+  } else if (scanner->in_key) {
+    scanner->in_key = false;
+    scanner->sdp_key =
+        scanner->key_matches && scanner->key_len == strlen(SDP_KEY);
+  }
+}
+
+static void sdp_scanner_feed(sdp_scanner_t *scanner, const char *data,
+                             size_t len) {
+  for (size_t i = 0; i < len && !scanner->done && !scanner->error; ++i) {
+    char c = data[i];
+
+    if (scanner->in_string) {
+      if (scanner->unicode_digits > 0) {
+        sdp_scanner_unicode_digit(scanner, c);
+      } else if (scanner->escape) {
+        scanner->escape = false;
+        sdp_scanner_escape(scanner, c);
+      } else if (c == '\\') {
+        scanner->escape = true;
+      } else if (c == '"') {
+        sdp_scanner_end_string(scanner);
+      } else {
+        sdp_scanner_string_char(scanner, c);
+      }
+      continue;
+    }
+
+    switch (c) {
+      case ' ':
+      case '\t':
+      case '\r':
+      case '\n':
+        break;
+      case '"':
+        scanner->in_string = true;
+        scanner->in_key = scanner->depth == 1 && scanner->expect_key;
+        scanner->capturing = scanner->sdp_value;
+        scanner->key_len = 0;
+        scanner->key_matches = true;
+        scanner->expect_key = false;
+        scanner->sdp_value = false;
+        break;
+      case ':':
+        scanner->sdp_value = scanner->depth == 1 && scanner->sdp_key;
+        scanner->sdp_key = false;
+        break;
+      case '{':
+      case '[':
+        scanner->depth++;
+        scanner->expect_key = c == '{';
+        scanner->sdp_value = false;
+        break;
+      case '}':
+      case ']':
+        scanner->depth--;
+        break;
+      case ',':
+        scanner->expect_key = scanner->depth == 1;
+        break;
+      default:
+        // Any other value (number, literal) for `sdp` is not an answer.
+        scanner->sdp_value = false;
+        break;
+    }
+  }
+}
+
+static esp_err_t http_post_offer(esp_http_client_handle_t client,
+                                 const char *offer) {
+  size_t content_length = strlen(OFFER_PREFIX) + json_escaped_length(offer) +
+                          strlen(OFFER_SUFFIX);
+
+  for (int redirects = 0;; ++redirects) {
+    esp_err_t err = esp_http_client_open(client, content_length);
+    if (err != ESP_OK) {
+      return err;
+    }
+
+    if (!http_write_offer(client, offer) ||
+        esp_http_client_fetch_headers(client) < 0) {
+      return ESP_FAIL;
+    }
+
+    int status_code = esp_http_client_get_status_code(client);
+    if (status_code == 200) {
+      return ESP_OK;
+    }
+
+    bool redirect = status_code == 301 || status_code == 302 ||
+                    status_code == 307 || status_code == 308;
+    if (!redirect || redirects == HTTP_MAX_REDIRECTS) {
+      ESP_LOGE(LOG_TAG, "Unexpected HTTP status %d", status_code);
+      return ESP_FAIL;
+    }
+
+    esp_http_client_flush_response(client, NULL);
+    esp_http_client_set_redirection(client);
+    esp_http_client_close(client);
+  }
+}
+
+char *pipecat_http_request(const char *offer) {
+  esp_http_client_config_t config;
+  memset(&config, 0, sizeof(esp_http_client_config_t));
+
+  config.url = PIPECAT_SMALLWEBRTC_URL;
+  config.method = HTTP_METHOD_POST;
+  config.timeout_ms = HTTP_TIMEOUT_MS;
+
+  ESP_LOGI(LOG_TAG, "Connecting to %s", config.url);
+  ESP_LOGD(LOG_TAG, "OFFER\n%s", offer);
+
+  esp_http_client_handle_t client = esp_http_client_init(&config);
+  if (client == NULL) {
+    ESP_LOGE(LOG_TAG, "Unable to create HTTP client");
+    return NULL;
+  }
+  esp_http_client_set_header(client, "Content-Type", "application/json");
+
+  esp_err_t err = http_post_offer(client, offer);
+  if (err != ESP_OK) {
+    ESP_LOGE(LOG_TAG, "Error perform http request %s", esp_err_to_name(err));
+    esp_http_client_cleanup(client);
+    return NULL;
+  }
+
+  sdp_scanner_t scanner;
+  memset(&scanner, 0, sizeof(sdp_scanner_t));
+  scanner.sdp_capacity = MAX_HTTP_OUTPUT_BUFFER;
+  scanner.sdp = (char *)malloc(scanner.sdp_capacity);
+  if (scanner.sdp == NULL) {
+    ESP_LOGE(LOG_TAG, "Unable to allocate SDP answer");
+    esp_http_client_cleanup(client);
+    return NULL;
+  }
+  scanner.sdp[0] = '\0';
+
+  char chunk[HTTP_CHUNK_SIZE];
+  while (!scanner.done && !scanner.error) {
+    int read_len = esp_http_client_read(client, chunk, sizeof(chunk));
+    if (read_len <= 0) {
+      break;
+    }
+    sdp_scanner_feed(&scanner, chunk, read_len);
+  }
+
+  esp_http_client_close(client);
+  esp_http_client_cleanup(client);
+
+  if (!scanner.done) {
+    ESP_LOGE(LOG_TAG, "Unable to find `sdp` field in response");
+    free(scanner.sdp);
+    return NULL;
+  }
+
+  ESP_LOGD(LOG_TAG, "ANSWER\n%s", scanner.sdp);
+
+  return scanner.sdp;
+}
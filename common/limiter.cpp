@@ -0,0 +1,166 @@
+#include <esp_log.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+
+// The limiter looks this far ahead, which is also the latency it adds
+#define LIMITER_LOOKAHEAD_MS 2
+// Output peaks stay below -1 dBFS
+#define LIMITER_CEILING 29204
+// After a peak the gain recovers by 1/2^5 of itself per block (~45 ms/6 dB)
+#define LIMITER_RELEASE_SHIFT 5
+
+// Speech is normalized to -16 dBFS RMS with 6 dB of cut and 12 dB of boost
+#define LOUDNESS_TARGET_RMS 5193
+#define LOUDNESS_MIN_GAIN_Q12 (1 << 11)
+#define LOUDNESS_MAX_GAIN_Q12 (4 << 12)
+// Frames quieter than this are pauses and leave the loudness gain alone
+#define LOUDNESS_SPEECH_RMS 300
+// The loudness gain follows speech over ~2^6 frames (~1.3 s)
+#define LOUDNESS_SMOOTHING_SHIFT 6
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+// Playback post-processing, shared by every board. A slow loudness gain
+// brings speech to a steady level and a look-ahead limiter pulls it down
+// ahead of any peak that would cross LIMITER_CEILING. Both are folded into a
+// single gain, ramped linearly over blocks of `lookahead` samples: the end of
+// every ramp is low enough for the block and the one after it, so no sample
+// overshoots and the final saturation only absorbs rounding. The per-sample
+// loops only use min/max, which the compiler turns into Xtensa MIN/MAX/CLAMPS
+// instead of branches.
+struct pipecat_limiter {
+  int lookahead;
+  size_t max_samples;
+  // The last `lookahead` input samples of the previous call, followed by room
+  // for the current input
+  int16_t *line;
+  int32_t loudness_gain_q12;
+  // Gain at the end of the last block, Q12
+  int32_t gain_q12;
+};
+
+static inline int32_t min32(int32_t a, int32_t b) { return a < b ? a : b; }
+static inline int32_t max32(int32_t a, int32_t b) { return a > b ? a : b; }
+
+static inline int16_t saturate(int32_t x) {
+  return (int16_t)max32(min32(x, INT16_MAX), INT16_MIN);
+}
+
+static int32_t PIPECAT_AUDIO_IRAM peak(const int16_t *pcm, size_t samples) {
+  int32_t peak = 1;
+  for (size_t i = 0; i < samples; i++) {
+    peak = max32(peak, abs(pcm[i]));
+  }
+  return peak;
+}
+
+static uint32_t PIPECAT_AUDIO_IRAM rms(const int16_t *pcm, size_t samples) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < samples; i++) {
+    sum += (int32_t)pcm[i] * pcm[i];
+  }
+  uint32_t mean = sum / samples;
+
+  uint32_t root = 0;
+  for (uint32_t bit = 1u << 30; bit != 0; bit >>= 2) {
+    if (mean >= root + bit) {
+      mean -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+  }
+  return root;
+}
+
+pipecat_limiter_t *pipecat_limiter_create(int sample_rate,
+                                          size_t max_samples) {
+  pipecat_limiter_t *l =
+      (pipecat_limiter_t *)calloc(1, sizeof(pipecat_limiter_t));
+  if (l == NULL) {
+    return NULL;
+  }
+
+  l->lookahead = sample_rate * LIMITER_LOOKAHEAD_MS / 1000;
+  l->max_samples = max_samples;
+  l->line = (int16_t *)calloc(l->lookahead + max_samples, sizeof(int16_t));
+  if (l->line == NULL) {
+    ESP_LOGE(LOG_TAG, "Unable to allocate the playback limiter");
+    free(l);
+    return NULL;
+  }
+  l->loudness_gain_q12 = 1 << 12;
+  l->gain_q12 = 1 << 12;
+  return l;
+}
+
+static void PIPECAT_AUDIO_IRAM update_loudness(pipecat_limiter_t *l,
+                                               const int16_t *pcm,
+                                               size_t samples) {
+  uint32_t level = rms(pcm, samples);
+  if (level < LOUDNESS_SPEECH_RMS) {
+    return;
+  }
+  int32_t desired = (LOUDNESS_TARGET_RMS << 12) / level;
+  desired = max32(min32(desired, LOUDNESS_MAX_GAIN_Q12), LOUDNESS_MIN_GAIN_Q12);
+  l->loudness_gain_q12 +=
+      (desired - l->loudness_gain_q12) >> LOUDNESS_SMOOTHING_SHIFT;
+}
+
+static void PIPECAT_AUDIO_IRAM limit(pipecat_limiter_t *l, int16_t *pcm,
+                                     size_t samples) {
+  update_loudness(l, pcm, samples);
+
+  const int lookahead = l->lookahead;
+  int16_t *line = l->line;
+  int16_t *x = line + lookahead;
+  memcpy(x, pcm, samples * sizeof(int16_t));
+
+  // Output is delayed by `lookahead`, so output sample i is line[i].
+  int32_t gain_q12 = l->gain_q12;
+  for (size_t start = 0; start < samples; start += lookahead) {
+    size_t length = MIN(samples - start, (size_t)lookahead);
+    // The block being played and the one after it
+    size_t window = MIN(length + lookahead, samples + lookahead - start);
+    int32_t limit_q12 = ((int32_t)LIMITER_CEILING << 12) /
+                        peak(line + start, window);
+
+    int32_t release = gain_q12 + (gain_q12 >> LIMITER_RELEASE_SHIFT) + 1;
+    int32_t target = min32(min32(release, l->loudness_gain_q12), limit_q12);
+
+    // Q20 ramp from the previous gain to the target
+    int32_t current = gain_q12 << 8;
+    int32_t step = ((target - gain_q12) << 8) / (int32_t)length;
+    for (size_t i = 0; i < length; i++) {
+      current += step;
+      pcm[start + i] = saturate((line[start + i] * (current >> 8)) >> 12);
+    }
+    gain_q12 = target;
+  }
+  l->gain_q12 = gain_q12;
+
+  memmove(line, x + samples - lookahead, lookahead * sizeof(int16_t));
+}
+
+void PIPECAT_AUDIO_IRAM pipecat_limiter_process(pipecat_limiter_t *l,
+                                                int16_t *pcm, size_t samples) {
+  while (samples > 0) {
+    size_t chunk = MIN(samples, l->max_samples);
+    limit(l, pcm, chunk);
+    pcm += chunk;
+    samples -= chunk;
+  }
+}
+
+void pipecat_limiter_destroy(pipecat_limiter_t *l) {
+  if (l == NULL) {
+    return;
+  }
+  free(l->line);
+  free(l);
+}
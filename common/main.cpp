@@ -0,0 +1,142 @@
+#include "main.h"
+
+#include <esp_event.h>
+#include <esp_log.h>
+#include <peer.h>
+
+#ifndef LINUX_BUILD
+#include <esp_netif.h>
+#include <freertos/event_groups.h>
+
+#include "nvs_flash.h"
+
+#define BOOT_WIFI_READY BIT0
+#define BOOT_MEDIA_READY BIT1
+#define BOOT_DISPLAY_READY BIT2
+
+// Boot runs as a small dependency graph: Wi-Fi association, the display and
+// the audio path come up on their own tasks while app_main creates the peer
+// connection and its DTLS certificate. The offer only waits for an address,
+// the WebRTC loop additionally for the audio path.
+static EventGroupHandle_t boot_event_group = NULL;
+
+static void pipecat_boot_wifi_task(void *user_data) {
+  pipecat_init_wifi();
+  xEventGroupSetBits(boot_event_group, BOOT_WIFI_READY);
+  pipecat_task_exit(PIPECAT_TASK_BOOT_WIFI);
+}
+
+static void pipecat_boot_display_task(void *user_data) {
+  pipecat_init_screen();
+  pipecat_timeline_mark(PIPECAT_PHASE_DISPLAY_INIT);
+  xEventGroupSetBits(boot_event_group, BOOT_DISPLAY_READY);
+  pipecat_task_exit(PIPECAT_TASK_BOOT_DISPLAY);
+}
+
+// On boards where the display and the codec are configured over the same I2C
+// controller, they come up in order on this task.
+static void pipecat_boot_media_task(void *user_data) {
+  EventBits_t ready = BOOT_MEDIA_READY;
+  if constexpr (board_traits::display_shares_codec_bus) {
+    pipecat_board_init();
+    pipecat_init_screen();
+    pipecat_timeline_mark(PIPECAT_PHASE_DISPLAY_INIT);
+    ready |= BOOT_DISPLAY_READY;
+  }
+
+  pipecat_board_init_audio();
+  pipecat_timeline_mark(PIPECAT_PHASE_CODEC_INIT);
+  pipecat_init_audio_decoder();
+  pipecat_init_audio_encoder();
+  xEventGroupSetBits(boot_event_group, ready);
+  pipecat_task_exit(PIPECAT_TASK_BOOT_MEDIA);
+}
+
+static void pipecat_start_boot_task(pipecat_task_t task,
+                                    TaskFunction_t function) {
+  if (pipecat_task_create(task, function, NULL) == NULL) {
+    esp_restart();
+  }
+}
+
+extern "C" void app_main(void) {
+  esp_err_t ret = nvs_flash_init();
+  if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
+      ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+    ESP_ERROR_CHECK(nvs_flash_erase());
+    ret = nvs_flash_init();
+  }
+  ESP_ERROR_CHECK(ret);
+  pipecat_timeline_mark(PIPECAT_PHASE_NVS_INIT);
+  pipecat_heap_init();
+#ifdef EVENT_TRACE
+  pipecat_init_trace();
+#endif
+
+  ESP_ERROR_CHECK(esp_event_loop_create_default());
+  ESP_ERROR_CHECK(esp_netif_init());
+
+  boot_event_group = xEventGroupCreate();
+  pipecat_start_boot_task(PIPECAT_TASK_BOOT_WIFI, pipecat_boot_wifi_task);
+  if constexpr (!board_traits::display_shares_codec_bus) {
+    pipecat_board_init();
+    pipecat_start_boot_task(PIPECAT_TASK_BOOT_DISPLAY,
+                            pipecat_boot_display_task);
+  }
+  pipecat_start_boot_task(PIPECAT_TASK_BOOT_MEDIA, pipecat_boot_media_task);
+
+  peer_init();
+#ifdef BENCHMARK_CRYPTO
+  pipecat_benchmark_crypto();
+#endif
+#ifdef BENCHMARK_AUDIO
+  pipecat_benchmark_audio();
+#endif
+  pipecat_init_dtls_certificate();
+  pipecat_init_webrtc();
+
+  xEventGroupWaitBits(boot_event_group, BOOT_WIFI_READY, pdFALSE, pdTRUE,
+                      portMAX_DELAY);
+  pipecat_webrtc_connect();
+
+  xEventGroupWaitBits(boot_event_group, BOOT_MEDIA_READY | BOOT_DISPLAY_READY,
+                      pdFALSE, pdTRUE, portMAX_DELAY);
+  pipecat_screen_system_log("Pipecat ESP32 client initialized\n");
+
+  while (1) {
+    pipecat_webrtc_loop();
+#ifdef TASK_REPORT
+    pipecat_task_report();
+#endif
+#ifdef MEMORY_PROFILE
+    pipecat_memory_report();
+#endif
+#ifdef FRAME_PROFILE
+    pipecat_profile_report();
+#endif
+    pipecat_heap_monitor();
+    vTaskDelay(pdMS_TO_TICKS(TICK_INTERVAL));
+  }
+}
+#else
+int main(void) {
+  ESP_ERROR_CHECK(esp_event_loop_create_default());
+#ifdef EVENT_TRACE
+  pipecat_init_trace();
+#endif
+#ifdef BENCHMARK_AUDIO
+  pipecat_benchmark_audio();
+#endif
+  peer_init();
+#ifdef BENCHMARK_CRYPTO
+  pipecat_benchmark_crypto();
+#endif
+  pipecat_init_webrtc();
+  pipecat_webrtc_connect();
+
+  while (1) {
+    pipecat_webrtc_loop();
+    vTaskDelay(pdMS_TO_TICKS(TICK_INTERVAL));
+  }
+}
+#endif
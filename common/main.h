@@ -0,0 +1,243 @@
+#include <cJSON.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <peer.h>
+
+#define LOG_TAG "pipecat"
+#define MAX_HTTP_OUTPUT_BUFFER 4096
+#define HTTP_TIMEOUT_MS 10000
+#define TICK_INTERVAL 15
+// Taps per phase of the polyphase resampler, see resampler.cpp
+#ifndef RESAMPLER_TAPS
+#define RESAMPLER_TAPS 16
+#endif
+
+// Capture DSP stages, see dsp.cpp
+#define PIPECAT_DSP_HIGHPASS (1 << 0)
+#define PIPECAT_DSP_NOISE_SUPPRESSION (1 << 1)
+#define PIPECAT_DSP_AGC (1 << 2)
+
+#ifndef LINUX_BUILD
+#include "board.h"
+#endif
+
+// Functions every audio frame runs through. AUDIO_IRAM links them into IRAM,
+// along with the Opus and SRTP objects in audio_iram.lf.
+#if defined(AUDIO_IRAM) && !defined(LINUX_BUILD)
+#include <esp_attr.h>
+#define PIPECAT_AUDIO_IRAM IRAM_ATTR
+#else
+#define PIPECAT_AUDIO_IRAM
+#endif
+
+// Wifi
+extern void pipecat_init_wifi();
+
+// WebRTC / Media
+extern void pipecat_init_audio_decoder();
+extern void pipecat_init_audio_encoder();
+extern void pipecat_send_audio(PeerConnection *peer_connection);
+extern void pipecat_audio_decode(uint8_t *data, size_t size);
+extern bool pipecat_audio_pending();
+extern void pipecat_audio_flush();
+
+// Clock drift
+#define DRIFT_RESAMPLE_SLACK 4
+extern void pipecat_drift_reset();
+extern int32_t pipecat_drift_update(int32_t queued_samples);
+extern size_t pipecat_drift_resample(const int16_t *in, size_t samples,
+                                     int16_t *out);
+
+// Resampling
+typedef struct pipecat_resampler pipecat_resampler_t;
+extern pipecat_resampler_t *pipecat_resampler_create(int in_rate, int out_rate,
+                                                     int taps,
+                                                     size_t max_samples);
+extern size_t pipecat_resampler_process(pipecat_resampler_t *r,
+                                        const int16_t *in, size_t samples,
+                                        int16_t *out);
+extern void pipecat_resampler_destroy(pipecat_resampler_t *r);
+
+// Capture DSP
+extern void pipecat_dsp_init(int sample_rate, uint32_t stages);
+extern void pipecat_dsp_set_enabled(uint32_t stages, bool enabled);
+extern void pipecat_dsp_process(int16_t *pcm, size_t samples);
+extern void pipecat_dsp_report();
+
+// Playback limiter
+typedef struct pipecat_limiter pipecat_limiter_t;
+extern pipecat_limiter_t *pipecat_limiter_create(int sample_rate,
+                                                 size_t max_samples);
+extern void pipecat_limiter_process(pipecat_limiter_t *l, int16_t *pcm,
+                                    size_t samples);
+extern void pipecat_limiter_destroy(pipecat_limiter_t *l);
+
+// Arenas and heap health, see arena.cpp
+#define PIPECAT_ARENA_ALIGNMENT 16
+#define PIPECAT_ARENA_ALIGN(size)           \
+  (((size) + PIPECAT_ARENA_ALIGNMENT - 1) & \
+   ~(size_t)(PIPECAT_ARENA_ALIGNMENT - 1))
+typedef struct pipecat_arena pipecat_arena_t;
+extern pipecat_arena_t *pipecat_arena_create(const char *name, size_t size,
+                                             uint32_t caps);
+extern void *pipecat_arena_alloc(pipecat_arena_t *arena, size_t size);
+extern void pipecat_heap_init();
+extern void pipecat_heap_monitor();
+
+// Frame profiler, see profile.cpp. The macros compile to nothing unless
+// FRAME_PROFILE is set.
+typedef enum {
+  PIPECAT_PROFILE_MIC_READ,
+  PIPECAT_PROFILE_CAPTURE_DSP,
+  PIPECAT_PROFILE_ENCODE,
+  PIPECAT_PROFILE_SEND,
+  PIPECAT_PROFILE_DECODE,
+  PIPECAT_PROFILE_POSTPROCESS,
+  PIPECAT_PROFILE_SPEAKER_WRITE,
+  PIPECAT_PROFILE_COUNT,
+} pipecat_profile_stage_t;
+
+#if defined(FRAME_PROFILE) && !defined(LINUX_BUILD)
+#include <esp_cpu.h>
+
+extern void pipecat_profile_record(pipecat_profile_stage_t stage,
+                                   uint32_t cycles);
+extern void pipecat_profile_report();
+#define PIPECAT_PROFILE_BEGIN(stage) \
+  uint32_t profile_start_##stage = esp_cpu_get_cycle_count()
+#define PIPECAT_PROFILE_END(stage) \
+  pipecat_profile_record(stage,    \
+                         esp_cpu_get_cycle_count() - profile_start_##stage)
+#else
+#define PIPECAT_PROFILE_BEGIN(stage)
+#define PIPECAT_PROFILE_END(stage)
+#endif
+
+// Event tracer, see trace.cpp. PIPECAT_TRACE compiles to nothing unless
+// EVENT_TRACE is set.
+typedef enum {
+  PIPECAT_TRACE_TASK_SWITCH,
+  PIPECAT_TRACE_FRAME_BEGIN,
+  PIPECAT_TRACE_FRAME_END,
+  PIPECAT_TRACE_QUEUE_SEND,
+  PIPECAT_TRACE_QUEUE_RECEIVE,
+  PIPECAT_TRACE_QUEUE_DROP,
+  PIPECAT_TRACE_PEER_LOOP_BEGIN,
+  PIPECAT_TRACE_PEER_LOOP_END,
+  PIPECAT_TRACE_DATACHANNEL_RECEIVE,
+  PIPECAT_TRACE_DATACHANNEL_SEND,
+} pipecat_trace_event_t;
+
+// Ids of the frame and queue events
+typedef enum {
+  PIPECAT_TRACE_FRAME_CAPTURE,
+  PIPECAT_TRACE_FRAME_DECODE,
+  PIPECAT_TRACE_FRAME_PLAY,
+} pipecat_trace_frame_t;
+
+typedef enum {
+  PIPECAT_TRACE_QUEUE_RTVI,
+  PIPECAT_TRACE_QUEUE_DECODE,
+  PIPECAT_TRACE_QUEUE_PLAY,
+} pipecat_trace_queue_t;
+
+#ifdef EVENT_TRACE
+extern void pipecat_trace(pipecat_trace_event_t event, uint32_t id,
+                          uint32_t size);
+extern void pipecat_init_trace();
+#define PIPECAT_TRACE(event, id, size) pipecat_trace(event, id, size)
+#else
+#define PIPECAT_TRACE(event, id, size)
+#endif
+
+// Beamforming
+extern void pipecat_beamform(const int16_t *capture, size_t samples,
+                             int channels, int mic_a, int mic_b, int16_t *out);
+
+// Tasks, see tasks.cpp for where each one runs
+typedef enum {
+  PIPECAT_TASK_BOOT_WIFI,
+  PIPECAT_TASK_BOOT_DISPLAY,
+  PIPECAT_TASK_BOOT_MEDIA,
+  PIPECAT_TASK_SIGNALLING,
+  PIPECAT_TASK_AUDIO_SEND,
+  PIPECAT_TASK_AUDIO_DECODE,
+  PIPECAT_TASK_AUDIO_PLAY,
+  PIPECAT_TASK_RTVI,
+  PIPECAT_TASK_SCREEN,
+  PIPECAT_TASK_LVGL,
+  PIPECAT_TASK_TRACE,
+  PIPECAT_TASK_COUNT,
+} pipecat_task_t;
+
+typedef struct {
+  const char *name;
+  BaseType_t core;
+  UBaseType_t priority;
+  uint32_t stack_size;
+  // Heap capabilities of the stack, 0 for the default heap
+  uint32_t stack_caps;
+} pipecat_task_config_t;
+
+extern const pipecat_task_config_t *pipecat_task_config(pipecat_task_t task);
+extern TaskHandle_t pipecat_task_create(pipecat_task_t task,
+                                        TaskFunction_t function, void *arg);
+extern void pipecat_task_exit(pipecat_task_t task);
+extern void pipecat_task_report();
+extern void pipecat_memory_report();
+
+// WebRTC / Signalling
+extern void pipecat_init_webrtc();
+extern void pipecat_webrtc_connect();
+extern void pipecat_webrtc_loop();
+extern char *pipecat_http_request(const char *offer);
+extern void pipecat_init_dtls_certificate();
+
+// Benchmarks
+extern void pipecat_benchmark_crypto();
+extern void pipecat_benchmark_audio();
+
+// RTVI
+typedef struct {
+  void (*on_bot_started_speaking)();
+  void (*on_bot_stopped_speaking)();
+  void (*on_bot_tts_text)(const char *text);
+  void (*on_user_started_speaking)();
+} rtvi_callbacks_t;
+
+extern rtvi_callbacks_t pipecat_rtvi_callbacks;
+
+extern void pipecat_init_rtvi(PeerConnection *peer_connection, rtvi_callbacks_t *callbacks);
+extern void pipecat_rtvi_datachannel_opened();
+extern void pipecat_rtvi_send_client_ready();
+extern void pipecat_rtvi_send_client_message(const char *t, cJSON *data);
+extern void pipecat_rtvi_handle_message(const char* msg);
+
+// Screen
+extern void pipecat_init_screen();
+extern void pipecat_screen_system_log(const char *text);
+extern void pipecat_screen_new_log();
+extern void pipecat_screen_log(const char *text);
+
+// Timeline
+typedef enum {
+  PIPECAT_PHASE_NVS_INIT,
+  PIPECAT_PHASE_DISPLAY_INIT,
+  PIPECAT_PHASE_CODEC_INIT,
+  PIPECAT_PHASE_WIFI_ASSOCIATED,
+  PIPECAT_PHASE_WIFI_GOT_IP,
+  PIPECAT_PHASE_CREATE_OFFER,
+  PIPECAT_PHASE_ICE_GATHERED,
+  PIPECAT_PHASE_ANSWER_RECEIVED,
+  PIPECAT_PHASE_ICE_CONNECTED,
+  // libpeer doesn't report the end of the DTLS handshake, this is the first
+  // data channel or audio event that needed it
+  PIPECAT_PHASE_FIRST_SECURE_DATA,
+  PIPECAT_PHASE_DATACHANNEL_OPEN,
+  PIPECAT_PHASE_FIRST_AUDIO_SENT,
+  PIPECAT_PHASE_FIRST_AUDIO_RECEIVED,
+  PIPECAT_PHASE_COUNT,
+} pipecat_phase_t;
+
+extern void pipecat_timeline_mark(pipecat_phase_t phase);
+extern void pipecat_timeline_report();
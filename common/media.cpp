@@ -0,0 +1,687 @@
+#include <inttypes.h>
+#include <opus.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/ringbuf.h"
+#include "main.h"
+
+#define SAMPLE_RATE (board_traits::sample_rate)
+// One 20 ms frame
+#define PCM_FRAME_SAMPLES (SAMPLE_RATE / 50)
+#define PCM_BUFFER_SIZE (PCM_FRAME_SAMPLES * sizeof(int16_t))
+
+// Opus may run at other rates than the codec, audio is resampled in between
+#ifndef OPUS_DECODER_SAMPLE_RATE
+#define OPUS_DECODER_SAMPLE_RATE SAMPLE_RATE
+#endif
+#ifndef OPUS_ENCODER_SAMPLE_RATE
+#define OPUS_ENCODER_SAMPLE_RATE SAMPLE_RATE
+#endif
+#define ENCODER_FRAME_SAMPLES (OPUS_ENCODER_SAMPLE_RATE / 50)
+// Longest frame Opus can decode (60 ms), at the decoder and the codec rate
+#define DECODER_MAX_SAMPLES (OPUS_DECODER_SAMPLE_RATE * 60 / 1000)
+#define PLAYBACK_MAX_SAMPLES (SAMPLE_RATE * 60 / 1000 + DRIFT_RESAMPLE_SLACK)
+
+#define OPUS_BUFFER_SIZE 1276  // 1276 bytes is recommended by opus_encode
+#define OPUS_ENCODER_COMPLEXITY 0
+// With DTX, frames this small only signal silence
+#define OPUS_DTX_FRAME_SIZE 2
+
+// Playback ends after 500 ms of silence
+#define PLAYBACK_SILENCE_FRAMES 25
+#define PLAYBACK_ACTIVITY_LEVEL (board_traits::playback_activity_level)
+#define PLAYBACK_ONSET_FRAMES (board_traits::playback_onset_frames)
+#define PLAYBACK_GATE_RMS (board_traits::playback_gate_rms)
+#define PLAY_BUFFER_FRAMES (board_traits::play_buffer_frames)
+// A queue that stays empty this long ends the utterance
+#define PLAY_IDLE_MS 100
+// Microphone frames louder than this while the bot plays are the user
+// talking over it, BARGE_IN_FRAMES of them in a row flush playback.
+#define BARGE_IN_RMS (board_traits::barge_in_rms)
+#define BARGE_IN_FRAMES (board_traits::barge_in_frames)
+
+// Packets wait here between the network and the decode task
+#define DECODE_QUEUE_PACKETS 8
+#define DECODE_PACKET_MAX_SIZE OPUS_BUFFER_SIZE
+// Packets between two decode time reports (10 s)
+#define DECODE_REPORT_PACKETS 500
+
+// Decoded audio kept while an onset is being confirmed and played ahead of
+// the frame that starts the utterance, so its first syllable isn't clipped
+#ifndef PLAYBACK_PREROLL_MS
+#define PLAYBACK_PREROLL_MS 60
+#endif
+#define PREROLL_SAMPLES (SAMPLE_RATE * PLAYBACK_PREROLL_MS / 1000)
+// Frames queued before an utterance starts playing: its onset frame and the
+// pre-roll, or as much lookahead of new frames against jitter where there is
+// no pre-roll. Afterwards the queue holds up to PLAY_BUFFER_FRAMES.
+#define PLAY_PRIME_FRAMES \
+  MIN(PLAYBACK_PREROLL_MS / 20 + 1, PLAY_BUFFER_FRAMES)
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+static constexpr bool is_opus_rate(int rate) {
+  return rate == 8000 || rate == 12000 || rate == 16000 || rate == 24000 ||
+         rate == 48000;
+}
+static_assert(is_opus_rate(OPUS_DECODER_SAMPLE_RATE) &&
+                  is_opus_rate(OPUS_ENCODER_SAMPLE_RATE),
+              "Opus only runs at 8, 12, 16, 24 or 48 kHz");
+
+// Boards with a buffered player or a half-duplex codec drop the frames that
+// arrive while nothing plays, the others play every decoded frame.
+static constexpr bool PLAYBACK_GATED =
+    PLAY_BUFFER_FRAMES > 0 || !board_traits::full_duplex;
+// Of those, only boards that confirm an onset before playing (a level above
+// the silence floor, or several frames) hold back speech. Elsewhere the
+// pre-roll would only ever keep silence.
+static constexpr bool PLAYBACK_PREROLL =
+    PLAYBACK_GATED && PREROLL_SAMPLES > 0 &&
+    (PLAYBACK_ACTIVITY_LEVEL > 1 || PLAYBACK_ONSET_FRAMES > 1);
+static_assert(BARGE_IN_RMS == 0 || board_traits::full_duplex,
+              "Barge-in needs the microphone running while the bot plays");
+
+static OpusDecoder *opus_decoder = NULL;
+static opus_int16 *decoder_buffer = NULL;
+static OpusEncoder *opus_encoder = NULL;
+static uint8_t *encoder_output_buffer = NULL;
+static int16_t *read_buffer = NULL;
+
+static pipecat_resampler_t *decoder_resampler = NULL;
+static int16_t *playback_buffer = NULL;
+static pipecat_limiter_t *limiter = NULL;
+static pipecat_resampler_t *encoder_resampler = NULL;
+static int16_t *encoder_input_buffer = NULL;
+
+static std::atomic<bool> is_playing = false;
+// Starts out as after the end of an utterance
+static int silence_frames = PLAYBACK_SILENCE_FRAMES;
+// Frames since the first active one of an utterance that hasn't started yet
+static std::atomic<int> onset_frames = 0;
+// Loud microphone frames in a row while the bot plays
+static int barge_in_frames = 0;
+
+static RingbufHandle_t play_queue = NULL;
+static StaticRingbuffer_t play_queue_struct;
+static std::atomic<int32_t> play_queue_samples = 0;
+static std::atomic<bool> play_primed = false;
+static int16_t *drift_buffer = NULL;
+
+// Single producer (network), single consumer (decode task) ring of packets.
+// Each side only writes its own index, so neither ever blocks the other.
+typedef struct {
+  size_t size;
+  uint8_t data[DECODE_PACKET_MAX_SIZE];
+} decode_packet_t;
+
+// Media buffers live for as long as the device, they are carved out of two
+// arenas sized here from the frame size, the Opus rates and the playback
+// buffer depth. The ones touched on every frame come first, the Opus states
+// are added at runtime.
+#define PLAY_QUEUE_SIZE (2 * PLAY_BUFFER_FRAMES * (PCM_BUFFER_SIZE + 8))
+static constexpr size_t MEDIA_ARENA_BUFFERS =
+    PIPECAT_ARENA_ALIGN(DECODER_MAX_SAMPLES * sizeof(opus_int16)) +
+    (OPUS_DECODER_SAMPLE_RATE != SAMPLE_RATE
+         ? PIPECAT_ARENA_ALIGN(PLAYBACK_MAX_SAMPLES * sizeof(int16_t))
+         : 0) +
+    (PLAY_BUFFER_FRAMES > 0
+         ? PIPECAT_ARENA_ALIGN(PLAYBACK_MAX_SAMPLES * sizeof(int16_t))
+         : 0) +
+    PIPECAT_ARENA_ALIGN(PCM_BUFFER_SIZE) +
+    PIPECAT_ARENA_ALIGN(OPUS_BUFFER_SIZE) +
+    (OPUS_ENCODER_SAMPLE_RATE != SAMPLE_RATE
+         ? PIPECAT_ARENA_ALIGN((ENCODER_FRAME_SAMPLES + 1) * sizeof(int16_t))
+         : 0);
+// Audio waiting to be decoded or played
+static constexpr size_t QUEUE_ARENA_SIZE =
+    PIPECAT_ARENA_ALIGN(PLAY_QUEUE_SIZE) +
+    (PLAYBACK_PREROLL ? PIPECAT_ARENA_ALIGN(PREROLL_SAMPLES * sizeof(int16_t))
+                      : 0) +
+    PIPECAT_ARENA_ALIGN(DECODE_QUEUE_PACKETS * sizeof(decode_packet_t));
+
+static pipecat_arena_t *media_arena = NULL;
+static pipecat_arena_t *queue_arena = NULL;
+
+static decode_packet_t *decode_queue = NULL;
+static std::atomic<uint32_t> decode_head = 0;
+static std::atomic<uint32_t> decode_tail = 0;
+static std::atomic<TaskHandle_t> decode_task = NULL;
+static std::atomic<uint32_t> decode_dropped = 0;
+
+static int16_t *preroll_buffer = NULL;
+static size_t preroll_head = 0;
+static size_t preroll_count = 0;
+
+// Bumped by pipecat_audio_flush(), the decoder and the play task each compare
+// it with the last flush they handled.
+static std::atomic<uint32_t> flush_generation = 0;
+static uint32_t decode_flush_generation = 0;
+// Set by a flush until the bot's audio falls silent
+static bool discarding = false;
+
+static void set_playing(bool playing) {
+  is_playing = playing;
+  // Full-duplex boards keep both directions running, a turn change never
+  // touches the peripherals.
+  if constexpr (!board_traits::full_duplex) {
+    pipecat_board_set_playing(playing);
+  }
+}
+
+static bool PIPECAT_AUDIO_IRAM is_silent(const int16_t *pcm, int samples) {
+  bool silent = true;
+  for (int i = 0; i < samples && silent; i++) {
+    silent = pcm[i] >= -PLAYBACK_ACTIVITY_LEVEL &&
+             pcm[i] <= PLAYBACK_ACTIVITY_LEVEL;
+  }
+  return silent;
+}
+
+// Whether the frame's RMS is below `rms`.
+static bool PIPECAT_AUDIO_IRAM is_quieter(const int16_t *pcm, size_t samples,
+                                          int rms) {
+  uint64_t energy = 0;
+  for (size_t i = 0; i < samples; i++) {
+    energy += (int32_t)pcm[i] * pcm[i];
+  }
+  return energy < (uint64_t)rms * rms * samples;
+}
+
+// Mutes frames below PLAYBACK_GATE_RMS, so that the limiter doesn't boost
+// the noise between words.
+static void PIPECAT_AUDIO_IRAM gate_playback(int16_t *pcm, size_t samples) {
+  if constexpr (PLAYBACK_GATE_RMS > 0) {
+    if (is_quieter(pcm, samples, PLAYBACK_GATE_RMS)) {
+      memset(pcm, 0, samples * sizeof(int16_t));
+    }
+  }
+}
+
+static void PIPECAT_AUDIO_IRAM update_playback_state(const int16_t *pcm,
+                                                     int samples) {
+  if (!is_silent(pcm, samples)) {
+    silence_frames = 0;
+  } else if (silence_frames < PLAYBACK_SILENCE_FRAMES &&
+             ++silence_frames == PLAYBACK_SILENCE_FRAMES) {
+    onset_frames = 0;
+    if (is_playing) {
+      set_playing(false);
+    }
+  }
+
+  // The onset counts from the first active frame until the silence ends it.
+  bool in_onset = onset_frames > 0 || silence_frames == 0;
+  if (!is_playing && in_onset && ++onset_frames >= PLAYBACK_ONSET_FRAMES) {
+    onset_frames = 0;
+    set_playing(true);
+  }
+}
+
+static void speaker_write(int16_t *pcm, size_t samples) {
+  PIPECAT_PROFILE_BEGIN(PIPECAT_PROFILE_SPEAKER_WRITE);
+  pipecat_board_write_audio(pcm, samples);
+  PIPECAT_PROFILE_END(PIPECAT_PROFILE_SPEAKER_WRITE);
+}
+
+// Ramps the frame down to silence so that a flush doesn't click.
+static void PIPECAT_AUDIO_IRAM fade_out(int16_t *pcm, size_t samples) {
+  int32_t gain = INT16_MAX;
+  int32_t step = INT16_MAX / (int32_t)samples;
+  for (size_t i = 0; i < samples; i++) {
+    gain -= step;
+    pcm[i] = (pcm[i] * gain) >> 15;
+  }
+}
+
+static void play_queued(void *frame, size_t size) {
+  size_t samples = size / sizeof(int16_t);
+  PIPECAT_TRACE(PIPECAT_TRACE_FRAME_BEGIN, PIPECAT_TRACE_FRAME_PLAY, size);
+  speaker_write((int16_t *)frame, samples);
+  PIPECAT_TRACE(PIPECAT_TRACE_FRAME_END, PIPECAT_TRACE_FRAME_PLAY, size);
+  vRingbufferReturnItem(play_queue, frame);
+  play_queue_samples -= samples;
+}
+
+static void drop_queued(void *frame, size_t size) {
+  vRingbufferReturnItem(play_queue, frame);
+  play_queue_samples -= size / sizeof(int16_t);
+}
+
+// Drops every frame queued for playback and what the speaker driver still
+// holds. While the speaker plays, the next frame is faded out instead so that
+// playback doesn't stop with a click.
+static void play_task_flush(void **held, size_t *held_size, int held_count,
+                            bool primed, void *frame, size_t size) {
+  for (int i = 0; i < held_count; i++) {
+    drop_queued(held[i], held_size[i]);
+  }
+  if (frame != NULL && primed) {
+    fade_out((int16_t *)frame, size / sizeof(int16_t));
+    pipecat_board_flush_audio((int16_t *)frame, size / sizeof(int16_t));
+    drop_queued(frame, size);
+  } else if (primed) {
+    pipecat_board_flush_audio(NULL, 0);
+  } else if (frame != NULL) {
+    drop_queued(frame, size);
+  }
+
+  while ((frame = xRingbufferReceive(play_queue, &size, 0)) != NULL) {
+    drop_queued(frame, size);
+  }
+}
+
+// Holds back the first PLAY_PRIME_FRAMES of every utterance so that network
+// jitter doesn't starve the speaker, then plays frames as they arrive.
+static void pipecat_play_task(void *user_data) {
+  void *held[PLAY_PRIME_FRAMES + 1];
+  size_t held_size[PLAY_PRIME_FRAMES + 1];
+  int held_count = 0;
+  bool primed = false;
+  uint32_t handled_flush = 0;
+
+  while (1) {
+    size_t size;
+    // Wakes up while idle too, so that a flush with nothing queued is
+    // consumed before the next utterance arrives.
+    void *frame =
+        xRingbufferReceive(play_queue, &size, pdMS_TO_TICKS(PLAY_IDLE_MS));
+    if (frame != NULL) {
+      PIPECAT_TRACE(PIPECAT_TRACE_QUEUE_RECEIVE, PIPECAT_TRACE_QUEUE_PLAY,
+                    size);
+    }
+
+    if (handled_flush != flush_generation) {
+      handled_flush = flush_generation;
+      play_task_flush(held, held_size, held_count, primed, frame, size);
+      held_count = 0;
+      primed = false;
+      play_primed = false;
+      continue;
+    }
+
+    if (frame != NULL && !primed && held_count < PLAY_PRIME_FRAMES) {
+      held[held_count] = frame;
+      held_size[held_count] = size;
+      if (++held_count < PLAY_PRIME_FRAMES) {
+        continue;
+      }
+      frame = NULL;
+    }
+
+    // The lookahead is queued or the utterance ended before it was.
+    primed = held_count == PLAY_PRIME_FRAMES || (primed && frame != NULL);
+    play_primed = primed;
+    for (int i = 0; i < held_count; i++) {
+      play_queued(held[i], held_size[i]);
+    }
+    held_count = 0;
+
+    if (frame != NULL) {
+      play_queued(frame, size);
+    }
+  }
+}
+
+static void PIPECAT_AUDIO_IRAM play_frame(int16_t *pcm, size_t samples) {
+  if constexpr (PLAY_BUFFER_FRAMES > 0) {
+    // Steer the queue level back to where it settled, see drift.cpp.
+    if (play_primed) {
+      pipecat_drift_update(play_queue_samples);
+    } else {
+      pipecat_drift_reset();
+    }
+    samples = pipecat_drift_resample(pcm, samples, drift_buffer);
+
+    size_t size = samples * sizeof(int16_t);
+    if (xRingbufferSend(play_queue, drift_buffer, size, 0) == pdTRUE) {
+      PIPECAT_TRACE(PIPECAT_TRACE_QUEUE_SEND, PIPECAT_TRACE_QUEUE_PLAY, size);
+      play_queue_samples += samples;
+    } else {
+      PIPECAT_TRACE(PIPECAT_TRACE_QUEUE_DROP, PIPECAT_TRACE_QUEUE_PLAY, size);
+    }
+  } else {
+    speaker_write(pcm, samples);
+  }
+}
+
+// Keeps the newest PREROLL_SAMPLES of the audio that wasn't played.
+static void PIPECAT_AUDIO_IRAM preroll_push(const int16_t *pcm,
+                                            size_t samples) {
+  if (samples > PREROLL_SAMPLES) {
+    pcm += samples - PREROLL_SAMPLES;
+    samples = PREROLL_SAMPLES;
+  }
+
+  size_t first = MIN(samples, PREROLL_SAMPLES - preroll_head);
+  memcpy(preroll_buffer + preroll_head, pcm, first * sizeof(int16_t));
+  memcpy(preroll_buffer, pcm + first, (samples - first) * sizeof(int16_t));
+  preroll_head += samples;
+  if (preroll_head >= PREROLL_SAMPLES) {
+    preroll_head -= PREROLL_SAMPLES;
+  }
+  preroll_count = MIN(preroll_count + samples, PREROLL_SAMPLES);
+}
+
+// Plays the kept audio oldest first, in frames of at most 20 ms.
+static void preroll_flush() {
+  size_t start = preroll_head >= preroll_count
+                     ? preroll_head - preroll_count
+                     : preroll_head + PREROLL_SAMPLES - preroll_count;
+  while (preroll_count > 0) {
+    size_t chunk = MIN(MIN(preroll_count, PREROLL_SAMPLES - start),
+                       (size_t)PCM_FRAME_SAMPLES);
+    play_frame(preroll_buffer + start, chunk);
+    start += chunk;
+    if (start >= PREROLL_SAMPLES) {
+      start = 0;
+    }
+    preroll_count -= chunk;
+  }
+}
+
+static void decode_packet(const uint8_t *data, size_t size) {
+  PIPECAT_PROFILE_BEGIN(PIPECAT_PROFILE_DECODE);
+  int decoded_size = opus_decode(opus_decoder, data, size, decoder_buffer,
+                                 DECODER_MAX_SAMPLES, 0);
+  PIPECAT_PROFILE_END(PIPECAT_PROFILE_DECODE);
+  if (decoded_size <= 0) {
+    return;
+  }
+
+  PIPECAT_PROFILE_BEGIN(PIPECAT_PROFILE_POSTPROCESS);
+  int16_t *pcm = decoder_buffer;
+  size_t samples = decoded_size;
+  if constexpr (OPUS_DECODER_SAMPLE_RATE != SAMPLE_RATE) {
+    samples = pipecat_resampler_process(decoder_resampler, decoder_buffer,
+                                        samples, playback_buffer);
+    pcm = playback_buffer;
+  }
+  gate_playback(pcm, samples);
+  pipecat_limiter_process(limiter, pcm, samples);
+  PIPECAT_PROFILE_END(PIPECAT_PROFILE_POSTPROCESS);
+
+  if (decode_flush_generation != flush_generation) {
+    decode_flush_generation = flush_generation;
+    discarding = true;
+    preroll_count = 0;
+    // The interrupted utterance is over.
+    silence_frames = PLAYBACK_SILENCE_FRAMES;
+    onset_frames = 0;
+    if (is_playing) {
+      // Buffered boards fade out in the play task.
+      if constexpr (PLAY_BUFFER_FRAMES == 0) {
+        fade_out(pcm, samples);
+        pipecat_board_flush_audio(pcm, samples);
+      }
+      set_playing(false);
+    }
+  }
+  // The rest of the interrupted utterance may still be in flight.
+  if (discarding) {
+    if (!is_silent(pcm, samples)) {
+      return;
+    }
+    discarding = false;
+  }
+
+  bool was_playing = is_playing;
+  update_playback_state(pcm, samples);
+
+  if constexpr (PLAYBACK_PREROLL) {
+    if (!is_playing) {
+      preroll_push(pcm, samples);
+      return;
+    }
+    if (!was_playing) {
+      preroll_flush();
+    }
+  } else if constexpr (PLAYBACK_GATED) {
+    if (!is_playing) {
+      return;
+    }
+  }
+
+  play_frame(pcm, samples);
+}
+
+// Decodes packets as the network hands them over and logs the average and
+// worst decode time every DECODE_REPORT_PACKETS.
+static void pipecat_decode_task(void *user_data) {
+  uint32_t packets = 0;
+  int64_t total_us = 0;
+  int64_t max_us = 0;
+
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    uint32_t tail = decode_tail.load(std::memory_order_relaxed);
+    while (tail != decode_head.load(std::memory_order_acquire)) {
+      decode_packet_t *packet = &decode_queue[tail % DECODE_QUEUE_PACKETS];
+      PIPECAT_TRACE(PIPECAT_TRACE_QUEUE_RECEIVE, PIPECAT_TRACE_QUEUE_DECODE,
+                    packet->size);
+
+      int64_t start = esp_timer_get_time();
+      PIPECAT_TRACE(PIPECAT_TRACE_FRAME_BEGIN, PIPECAT_TRACE_FRAME_DECODE,
+                    packet->size);
+      decode_packet(packet->data, packet->size);
+      PIPECAT_TRACE(PIPECAT_TRACE_FRAME_END, PIPECAT_TRACE_FRAME_DECODE,
+                    packet->size);
+      int64_t elapsed = esp_timer_get_time() - start;
+
+      decode_tail.store(++tail, std::memory_order_release);
+
+      total_us += elapsed;
+      max_us = elapsed > max_us ? elapsed : max_us;
+      if (++packets == DECODE_REPORT_PACKETS) {
+        ESP_LOGD(LOG_TAG,
+                 "Decode: %" PRId64 " us/packet avg, %" PRId64
+                 " us max, %lu dropped",
+                 total_us / packets, max_us,
+                 (unsigned long)decode_dropped.exchange(0));
+        packets = 0;
+        total_us = 0;
+        max_us = 0;
+      }
+    }
+  }
+}
+
+// Allocates both arenas on the first call.
+static void init_media_arenas() {
+  if (media_arena != NULL) {
+    return;
+  }
+  size_t opus_states = PIPECAT_ARENA_ALIGN(opus_decoder_get_size(1)) +
+                       PIPECAT_ARENA_ALIGN(opus_encoder_get_size(1));
+  media_arena = pipecat_arena_create("media", MEDIA_ARENA_BUFFERS + opus_states,
+                                     board_traits::buffer_caps);
+  queue_arena = pipecat_arena_create("media queues", QUEUE_ARENA_SIZE,
+                                     board_traits::bulk_buffer_caps);
+}
+
+void pipecat_init_audio_decoder() {
+  init_media_arenas();
+  opus_decoder = (OpusDecoder *)pipecat_arena_alloc(media_arena,
+                                                    opus_decoder_get_size(1));
+  if (opus_decoder == NULL ||
+      opus_decoder_init(opus_decoder, OPUS_DECODER_SAMPLE_RATE, 1) !=
+          OPUS_OK) {
+    printf("Failed to create OPUS decoder");
+    return;
+  }
+
+  decoder_buffer = (opus_int16 *)pipecat_arena_alloc(
+      media_arena, DECODER_MAX_SAMPLES * sizeof(opus_int16));
+
+  if constexpr (OPUS_DECODER_SAMPLE_RATE != SAMPLE_RATE) {
+    decoder_resampler =
+        pipecat_resampler_create(OPUS_DECODER_SAMPLE_RATE, SAMPLE_RATE,
+                                 RESAMPLER_TAPS, DECODER_MAX_SAMPLES);
+    playback_buffer = (int16_t *)pipecat_arena_alloc(
+        media_arena, PLAYBACK_MAX_SAMPLES * sizeof(int16_t));
+  }
+  limiter = pipecat_limiter_create(SAMPLE_RATE, PLAYBACK_MAX_SAMPLES);
+
+  if constexpr (PLAY_BUFFER_FRAMES > 0) {
+    // Room for a full buffer being played while the next one queues up.
+    play_queue = xRingbufferCreateStatic(
+        PLAY_QUEUE_SIZE, RINGBUF_TYPE_NOSPLIT,
+        (uint8_t *)pipecat_arena_alloc(queue_arena, PLAY_QUEUE_SIZE),
+        &play_queue_struct);
+    drift_buffer = (int16_t *)pipecat_arena_alloc(
+        media_arena, PLAYBACK_MAX_SAMPLES * sizeof(int16_t));
+    pipecat_task_create(PIPECAT_TASK_AUDIO_PLAY, pipecat_play_task, NULL);
+  }
+
+  if constexpr (PLAYBACK_PREROLL) {
+    preroll_buffer = (int16_t *)pipecat_arena_alloc(
+        queue_arena, PREROLL_SAMPLES * sizeof(int16_t));
+  }
+
+  decode_queue = (decode_packet_t *)pipecat_arena_alloc(
+      queue_arena, DECODE_QUEUE_PACKETS * sizeof(decode_packet_t));
+  if (decode_queue == NULL) {
+    ESP_LOGE(LOG_TAG, "Unable to allocate the decode queue");
+    return;
+  }
+  decode_task =
+      pipecat_task_create(PIPECAT_TASK_AUDIO_DECODE, pipecat_decode_task, NULL);
+}
+
+// Called from the network loop, only copies the packet and wakes up the
+// decode task. A full queue drops the packet rather than stall the network.
+void pipecat_audio_decode(uint8_t *data, size_t size) {
+  uint32_t head = decode_head.load(std::memory_order_relaxed);
+  if (decode_task == NULL || size > DECODE_PACKET_MAX_SIZE ||
+      head - decode_tail.load(std::memory_order_acquire) ==
+          DECODE_QUEUE_PACKETS) {
+    PIPECAT_TRACE(PIPECAT_TRACE_QUEUE_DROP, PIPECAT_TRACE_QUEUE_DECODE, size);
+    decode_dropped++;
+    return;
+  }
+
+  decode_packet_t *packet = &decode_queue[head % DECODE_QUEUE_PACKETS];
+  memcpy(packet->data, data, size);
+  packet->size = size;
+  PIPECAT_TRACE(PIPECAT_TRACE_QUEUE_SEND, PIPECAT_TRACE_QUEUE_DECODE, size);
+  decode_head.store(head + 1, std::memory_order_release);
+  xTaskNotifyGive(decode_task);
+}
+
+// Whether any of the bot's audio is playing, queued for the speaker or held
+// while its onset is confirmed. Packets waiting to be decoded don't count, the
+// bot's silence keeps them coming on full-duplex boards.
+bool pipecat_audio_pending() {
+  return is_playing || play_queue_samples > 0 || onset_frames > 0;
+}
+
+// Stops playback within a frame, dropping everything queued on the device.
+// Safe to call from any task.
+void pipecat_audio_flush() {
+  flush_generation++;
+  ESP_LOGI(LOG_TAG, "Flushing playback");
+}
+
+void pipecat_init_audio_encoder() {
+  init_media_arenas();
+  opus_encoder = (OpusEncoder *)pipecat_arena_alloc(media_arena,
+                                                    opus_encoder_get_size(1));
+  if (opus_encoder == NULL ||
+      opus_encoder_init(opus_encoder, OPUS_ENCODER_SAMPLE_RATE, 1,
+                        OPUS_APPLICATION_VOIP) != OPUS_OK) {
+    printf("Failed to create OPUS encoder");
+    return;
+  }
+
+  opus_encoder_ctl(opus_encoder, OPUS_SET_BITRATE(board_traits::opus_bitrate));
+  opus_encoder_ctl(opus_encoder, OPUS_SET_COMPLEXITY(OPUS_ENCODER_COMPLEXITY));
+  opus_encoder_ctl(opus_encoder, OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE));
+  opus_encoder_ctl(opus_encoder, OPUS_SET_VBR(board_traits::opus_vbr));
+  opus_encoder_ctl(opus_encoder, OPUS_SET_DTX(board_traits::opus_dtx));
+
+  pipecat_dsp_init(SAMPLE_RATE, board_traits::capture_dsp);
+  read_buffer = (int16_t *)pipecat_arena_alloc(media_arena, PCM_BUFFER_SIZE);
+  encoder_output_buffer =
+      (uint8_t *)pipecat_arena_alloc(media_arena, OPUS_BUFFER_SIZE);
+
+  if constexpr (OPUS_ENCODER_SAMPLE_RATE != SAMPLE_RATE) {
+    encoder_resampler =
+        pipecat_resampler_create(SAMPLE_RATE, OPUS_ENCODER_SAMPLE_RATE,
+                                 RESAMPLER_TAPS, PCM_FRAME_SAMPLES);
+    encoder_input_buffer = (int16_t *)pipecat_arena_alloc(
+        media_arena, (ENCODER_FRAME_SAMPLES + 1) * sizeof(int16_t));
+  }
+}
+
+// Counts the frames the microphone picks up above BARGE_IN_RMS while the bot
+// plays. The uplink is muted meanwhile, so the server can't hear the user
+// interrupt; the device flushes its own playback and the server hears the
+// user once it ends.
+static void PIPECAT_AUDIO_IRAM detect_barge_in(const int16_t *pcm,
+                                               size_t samples) {
+  if constexpr (BARGE_IN_RMS > 0) {
+    if (is_quieter(pcm, samples, BARGE_IN_RMS)) {
+      barge_in_frames = 0;
+    } else if (++barge_in_frames == BARGE_IN_FRAMES) {
+      pipecat_audio_flush();
+    }
+  }
+}
+
+void pipecat_send_audio(PeerConnection *peer_connection) {
+  if (board_traits::full_duplex || !is_playing) {
+    // Mostly time spent waiting for the codec to fill the frame.
+    PIPECAT_PROFILE_BEGIN(PIPECAT_PROFILE_MIC_READ);
+    bool read = pipecat_board_read_audio(read_buffer, PCM_FRAME_SAMPLES);
+    PIPECAT_PROFILE_END(PIPECAT_PROFILE_MIC_READ);
+    if (!read) {
+      return;
+    }
+  } else {
+    // The microphone is off while the speaker plays, keep the frame pace.
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+
+  // Don't send the bot's own voice back.
+  if (is_playing) {
+    detect_barge_in(read_buffer, PCM_FRAME_SAMPLES);
+    memset(read_buffer, 0, PCM_BUFFER_SIZE);
+  } else {
+    barge_in_frames = 0;
+    PIPECAT_PROFILE_BEGIN(PIPECAT_PROFILE_CAPTURE_DSP);
+    pipecat_dsp_process(read_buffer, PCM_FRAME_SAMPLES);
+    PIPECAT_PROFILE_END(PIPECAT_PROFILE_CAPTURE_DSP);
+  }
+
+  int16_t *pcm = read_buffer;
+  if constexpr (OPUS_ENCODER_SAMPLE_RATE != SAMPLE_RATE) {
+    // 20 ms at every Opus rate is a whole number of samples, so each frame
+    // resamples to exactly ENCODER_FRAME_SAMPLES.
+    pipecat_resampler_process(encoder_resampler, read_buffer,
+                              PCM_FRAME_SAMPLES, encoder_input_buffer);
+    pcm = encoder_input_buffer;
+  }
+
+  PIPECAT_PROFILE_BEGIN(PIPECAT_PROFILE_ENCODE);
+  int encoded_size =
+      opus_encode(opus_encoder, pcm, ENCODER_FRAME_SAMPLES,
+                  encoder_output_buffer, OPUS_BUFFER_SIZE);
+  PIPECAT_PROFILE_END(PIPECAT_PROFILE_ENCODE);
+  if (encoded_size <= 0 ||
+      (board_traits::opus_dtx && encoded_size <= OPUS_DTX_FRAME_SIZE)) {
+    return;
+  }
+
+  PIPECAT_PROFILE_BEGIN(PIPECAT_PROFILE_SEND);
+  peer_connection_send_audio(peer_connection, encoder_output_buffer,
+                             encoded_size);
+  PIPECAT_PROFILE_END(PIPECAT_PROFILE_SEND);
+  pipecat_timeline_mark(PIPECAT_PHASE_FIRST_AUDIO_SENT);
+}
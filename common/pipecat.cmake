@@ -0,0 +1,163 @@
+# Build options shared by every board. The board's CMakeLists.txt calls
+# pipecat_project_options before and pipecat_project_hooks after including
+# project.cmake, its src/CMakeLists.txt registers the component with
+# pipecat_component_register. Only what differs between boards stays in the
+# board's files.
+
+set(PIPECAT_COMMON_PATH "${CMAKE_CURRENT_LIST_DIR}")
+# The submodules live with the S3-Box-3 and are shared by every board
+set(PIPECAT_COMPONENTS_PATH "${CMAKE_CURRENT_LIST_DIR}/../esp32-s3-box-3/components")
+
+macro(pipecat_project_options)
+  if(NOT IDF_TARGET STREQUAL linux)
+    if(NOT DEFINED ENV{WIFI_SSID} OR NOT DEFINED ENV{WIFI_PASSWORD})
+      message(FATAL_ERROR "Env variables WIFI_SSID and WIFI_PASSWORD must be set")
+    endif()
+
+    add_compile_definitions(WIFI_SSID="$ENV{WIFI_SSID}")
+    add_compile_definitions(WIFI_PASSWORD="$ENV{WIFI_PASSWORD}")
+
+    if(DEFINED ENV{WIFI_STATIC_IP})
+      if(NOT DEFINED ENV{WIFI_STATIC_NETMASK} OR NOT DEFINED ENV{WIFI_STATIC_GATEWAY})
+        message(FATAL_ERROR "Env variables WIFI_STATIC_NETMASK and WIFI_STATIC_GATEWAY must be set with WIFI_STATIC_IP")
+      endif()
+
+      add_compile_definitions(WIFI_STATIC_IP="$ENV{WIFI_STATIC_IP}")
+      add_compile_definitions(WIFI_STATIC_NETMASK="$ENV{WIFI_STATIC_NETMASK}")
+      add_compile_definitions(WIFI_STATIC_GATEWAY="$ENV{WIFI_STATIC_GATEWAY}")
+      if(DEFINED ENV{WIFI_STATIC_DNS})
+        add_compile_definitions(WIFI_STATIC_DNS="$ENV{WIFI_STATIC_DNS}")
+      else()
+        add_compile_definitions(WIFI_STATIC_DNS="$ENV{WIFI_STATIC_GATEWAY}")
+      endif()
+    endif()
+  endif()
+
+  if(NOT DEFINED ENV{PIPECAT_SMALLWEBRTC_URL})
+    message(FATAL_ERROR "Env variable PIPECAT_SMALLWEBRTC_URL must be set")
+  endif()
+
+  # Switches, defined when the env variable is set
+  foreach(option LOG_DATACHANNEL_MESSAGES BENCHMARK_CRYPTO BENCHMARK_AUDIO
+      TASK_REPORT MEMORY_PROFILE AUDIO_IRAM FRAME_PROFILE EVENT_TRACE)
+    if(DEFINED ENV{${option}})
+      add_compile_definitions(${option}="1")
+    endif()
+  endforeach()
+
+  # Values, passed on as they are set
+  foreach(option DTLS_CERT_MAX_USES PLAYBACK_PREROLL_MS
+      OPUS_DECODER_SAMPLE_RATE OPUS_ENCODER_SAMPLE_RATE RESAMPLER_TAPS)
+    if(DEFINED ENV{${option}})
+      add_compile_definitions(${option}=$ENV{${option}})
+    endif()
+  endforeach()
+
+  add_compile_definitions(PIPECAT_SMALLWEBRTC_URL="$ENV{PIPECAT_SMALLWEBRTC_URL}")
+
+  set(COMPONENTS src)
+  set(EXTRA_COMPONENT_DIRS "src"
+    "${PIPECAT_COMPONENTS_PATH}/srtp"
+    "${PIPECAT_COMPONENTS_PATH}/peer"
+    "${PIPECAT_COMPONENTS_PATH}/esp-libopus")
+
+  if(IDF_TARGET STREQUAL linux)
+    add_compile_definitions(LINUX_BUILD=1)
+    list(APPEND EXTRA_COMPONENT_DIRS
+      $ENV{IDF_PATH}/examples/protocols/linux_stubs/esp_stubs
+      "${PIPECAT_COMPONENTS_PATH}/esp-protocols/common_components/linux_compat/esp_timer"
+      "${PIPECAT_COMPONENTS_PATH}/esp-protocols/common_components/linux_compat/freertos"
+      )
+  endif()
+endmacro()
+
+macro(pipecat_project_hooks)
+  # Hands FreeRTOS the tracer's task switch hook, see trace_hooks.h
+  if(DEFINED ENV{EVENT_TRACE} AND NOT IDF_TARGET STREQUAL linux)
+    idf_build_set_property(COMPILE_OPTIONS
+      "-include;${PIPECAT_COMMON_PATH}/trace_hooks.h" APPEND)
+  endif()
+endmacro()
+
+# Registers the board's src component with the shared sources.
+# DEVICE_SRCS are the board's own sources and REQUIRES the components they
+# need on top of the shared ones, both left out of the Linux build. A macro
+# rather than a function, idf_component_register returns early from the
+# calling CMakeLists.txt while IDF collects the requirements.
+macro(pipecat_component_register)
+  cmake_parse_arguments(PIPECAT "" "" "DEVICE_SRCS;REQUIRES" ${ARGN})
+
+  set(COMMON_SRC
+    "${PIPECAT_COMMON_PATH}/webrtc.cpp"
+    "${PIPECAT_COMMON_PATH}/main.cpp"
+    "${PIPECAT_COMMON_PATH}/http.cpp"
+    "${PIPECAT_COMMON_PATH}/rtvi.cpp"
+    "${PIPECAT_COMMON_PATH}/rtvi_callbacks.cpp"
+    "${PIPECAT_COMMON_PATH}/timeline.cpp"
+    "${PIPECAT_COMMON_PATH}/tasks.cpp"
+    "${PIPECAT_COMMON_PATH}/resampler.cpp"
+    "${PIPECAT_COMMON_PATH}/limiter.cpp"
+    "${PIPECAT_COMMON_PATH}/benchmark.cpp"
+    "${PIPECAT_COMMON_PATH}/benchmark_audio.cpp")
+  set(DEVICE_SRC
+    "${PIPECAT_COMMON_PATH}/wifi.cpp"
+    "${PIPECAT_COMMON_PATH}/media.cpp"
+    "${PIPECAT_COMMON_PATH}/arena.cpp"
+    "${PIPECAT_COMMON_PATH}/drift.cpp"
+    "${PIPECAT_COMMON_PATH}/dsp.cpp"
+    "${PIPECAT_COMMON_PATH}/dtls.cpp"
+    ${PIPECAT_DEVICE_SRCS})
+
+  # Event tracer, see trace.cpp
+  if(DEFINED ENV{EVENT_TRACE})
+    list(APPEND COMMON_SRC "${PIPECAT_COMMON_PATH}/trace.cpp")
+  endif()
+
+  # Frame stage timing, see profile.cpp
+  if(DEFINED ENV{FRAME_PROFILE})
+    list(APPEND DEVICE_SRC "${PIPECAT_COMMON_PATH}/profile.cpp")
+  endif()
+
+  # Runs the audio frame path from IRAM, see audio_iram.lf
+  set(DEVICE_LDFRAGMENTS)
+  if(DEFINED ENV{AUDIO_IRAM})
+    list(APPEND DEVICE_LDFRAGMENTS "${PIPECAT_COMMON_PATH}/audio_iram.lf")
+  endif()
+
+  if(IDF_TARGET STREQUAL linux)
+    idf_component_register(
+      SRCS ${COMMON_SRC}
+      INCLUDE_DIRS "${PIPECAT_COMMON_PATH}"
+      REQUIRES peer esp-libopus esp_http_client esp_timer json srtp)
+  else()
+    idf_component_register(
+      SRCS ${COMMON_SRC} ${DEVICE_SRC}
+      INCLUDE_DIRS "." "${PIPECAT_COMMON_PATH}"
+      LDFRAGMENTS ${DEVICE_LDFRAGMENTS}
+      REQUIRES driver esp_wifi nvs_flash peer esp_psram esp-libopus esp_http_client json mbedtls srtp ${PIPECAT_REQUIRES})
+
+    # libpeer's DTLS key and certificate are served from NVS, see dtls.cpp
+    target_link_libraries(${COMPONENT_LIB} INTERFACE
+      "-Wl,--wrap=dtls_srtp_init"
+      "-Wl,--wrap=mbedtls_ecp_gen_key"
+      "-Wl,--wrap=mbedtls_x509write_crt_pem")
+  endif()
+
+  idf_component_get_property(lib peer COMPONENT_LIB)
+  target_compile_options(${lib} PRIVATE -Wno-error=restrict)
+  target_compile_options(${lib} PRIVATE -Wno-error=stringop-truncation)
+
+  idf_component_get_property(lib srtp COMPONENT_LIB)
+  target_compile_options(${lib} PRIVATE -Wno-error=incompatible-pointer-types)
+  # The SRTP benchmark only credits the mbedTLS accelerators when libsrtp is
+  # built on mbedTLS, see benchmark.cpp
+  get_target_property(srtp_sources ${lib} SOURCES)
+  list(FILTER srtp_sources INCLUDE REGEX "aes_icm_mbedtls\\.c$")
+  if(srtp_sources)
+    target_compile_definitions(${COMPONENT_LIB} PRIVATE SRTP_CRYPTO_MBEDTLS=1)
+  endif()
+
+  idf_component_get_property(lib esp-libopus COMPONENT_LIB)
+  target_compile_options(${lib} PRIVATE -Wno-error=maybe-uninitialized)
+  target_compile_options(${lib} PRIVATE -Wno-error=stringop-overread)
+endmacro()
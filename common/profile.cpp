@@ -0,0 +1,168 @@
+#include <cJSON.h>
+#include <esp_log.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "main.h"
+
+// Minimum time between two frame profile reports
+#define PROFILE_REPORT_INTERVAL_MS 10000
+// Every frame has to be captured, encoded, decoded and played within this
+#define PROFILE_FRAME_DEADLINE_US 20000
+// Buckets per doubling of the duration, the p99 is exact to 1/8th of it
+#define PROFILE_BUCKET_BITS 3
+#define PROFILE_BUCKETS_PER_OCTAVE (1 << PROFILE_BUCKET_BITS)
+// Up to 2^25 us (33 s), longer stages land in the last bucket
+#define PROFILE_BUCKETS (23 * PROFILE_BUCKETS_PER_OCTAVE)
+#define PROFILE_CYCLES_PER_US CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+
+static const char *STAGE_NAMES[PIPECAT_PROFILE_COUNT] = {
+    "mic_read", "capture_dsp", "encode",       "send",
+    "decode",   "postprocess", "speaker_write",
+};
+
+typedef struct {
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t total_us;
+  uint16_t buckets[PROFILE_BUCKETS];
+} profile_stage_t;
+
+// Stages record into one window while the report reads the other, so the
+// audio tasks never wait on the main loop.
+static profile_stage_t windows[2][PIPECAT_PROFILE_COUNT];
+static std::atomic<int> active_window = 0;
+// Records in progress per window, the report waits for them to drain after a
+// swap
+static std::atomic<uint32_t> window_writers[2];
+
+// Log-linear buckets: exact below PROFILE_BUCKETS_PER_OCTAVE us, then
+// PROFILE_BUCKETS_PER_OCTAVE buckets per power of two.
+static int PIPECAT_AUDIO_IRAM bucket_index(uint32_t us) {
+  if (us < PROFILE_BUCKETS_PER_OCTAVE) {
+    return us;
+  }
+  int msb = 31 - __builtin_clz(us);
+  int index = (msb - PROFILE_BUCKET_BITS + 1) * PROFILE_BUCKETS_PER_OCTAVE +
+              ((us >> (msb - PROFILE_BUCKET_BITS)) &
+               (PROFILE_BUCKETS_PER_OCTAVE - 1));
+  return index < PROFILE_BUCKETS ? index : PROFILE_BUCKETS - 1;
+}
+
+// Largest duration that falls into the bucket.
+static uint32_t bucket_limit(int index) {
+  if (index < PROFILE_BUCKETS_PER_OCTAVE) {
+    return index;
+  }
+  int shift = index / PROFILE_BUCKETS_PER_OCTAVE - 1;
+  uint32_t base = PROFILE_BUCKETS_PER_OCTAVE +
+                  index % PROFILE_BUCKETS_PER_OCTAVE;
+  return ((base + 1) << shift) - 1;
+}
+
+// Each stage is only ever recorded from one task, see media.cpp.
+void PIPECAT_AUDIO_IRAM pipecat_profile_record(pipecat_profile_stage_t stage,
+                                               uint32_t cycles) {
+  int window;
+  while (true) {
+    window = active_window.load();
+    window_writers[window].fetch_add(1);
+    // A swap between the load and the increment may not have seen this
+    // record, move over to the new window.
+    if (active_window.load() == window) {
+      break;
+    }
+    window_writers[window].fetch_sub(1);
+  }
+
+  profile_stage_t *s = &windows[window][stage];
+  uint32_t us = cycles / PROFILE_CYCLES_PER_US;
+
+  if (s->count == 0 || us < s->min_us) {
+    s->min_us = us;
+  }
+  if (us > s->max_us) {
+    s->max_us = us;
+  }
+  s->total_us += us;
+  s->count++;
+
+  uint16_t *bucket = &s->buckets[bucket_index(us)];
+  if (*bucket < UINT16_MAX) {
+    (*bucket)++;
+  }
+  window_writers[window].fetch_sub(1, std::memory_order_release);
+}
+
+static uint32_t percentile(const profile_stage_t *s, uint32_t percent) {
+  uint32_t rank = (s->count * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int i = 0; i < PROFILE_BUCKETS; i++) {
+    seen += s->buckets[i];
+    if (seen >= rank) {
+      // The bucket limit overestimates, but never beyond the worst frame.
+      uint32_t limit = bucket_limit(i);
+      return limit < s->max_us ? limit : s->max_us;
+    }
+  }
+  return s->max_us;
+}
+
+static void add_stage(cJSON *stages, const char *name,
+                      const profile_stage_t *s, uint32_t p99) {
+  cJSON *stage = cJSON_AddObjectToObject(stages, name);
+  if (stage == NULL) {
+    return;
+  }
+  cJSON_AddNumberToObject(stage, "count", s->count);
+  cJSON_AddNumberToObject(stage, "min_us", s->min_us);
+  cJSON_AddNumberToObject(stage, "avg_us", (double)(s->total_us / s->count));
+  cJSON_AddNumberToObject(stage, "p99_us", p99);
+  cJSON_AddNumberToObject(stage, "max_us", s->max_us);
+}
+
+// Logs min/avg/p99/max of every stage measured since the previous report and
+// sends the same numbers to the bot as an RTVI client message. Called from
+// the main loop, rate limited to PROFILE_REPORT_INTERVAL_MS.
+void pipecat_profile_report() {
+  static TickType_t last_report = 0;
+  TickType_t now = xTaskGetTickCount();
+  if (now - last_report < pdMS_TO_TICKS(PROFILE_REPORT_INTERVAL_MS)) {
+    return;
+  }
+  last_report = now;
+
+  int window = active_window.load();
+  active_window.store(!window);
+  // A record that started before the swap finishes within microseconds,
+  // unless its task was preempted.
+  while (window_writers[window].load() != 0) {
+    vTaskDelay(1);
+  }
+  profile_stage_t *stages = windows[window];
+
+  cJSON *data = cJSON_CreateObject();
+  cJSON *j_stages = cJSON_AddObjectToObject(data, "stages");
+  cJSON_AddNumberToObject(data, "deadline_us", PROFILE_FRAME_DEADLINE_US);
+
+  ESP_LOGI(LOG_TAG, "%-14s %6s %7s %7s %7s %7s", "Stage (us)", "Count", "Min",
+           "Avg", "P99", "Max");
+  for (int i = 0; i < PIPECAT_PROFILE_COUNT; i++) {
+    const profile_stage_t *s = &stages[i];
+    if (s->count == 0) {
+      continue;
+    }
+    uint32_t p99 = percentile(s, 99);
+    ESP_LOGI(LOG_TAG, "%-14s %6lu %7lu %7lu %7lu %7lu", STAGE_NAMES[i],
+             (unsigned long)s->count, (unsigned long)s->min_us,
+             (unsigned long)(s->total_us / s->count), (unsigned long)p99,
+             (unsigned long)s->max_us);
+    add_stage(j_stages, STAGE_NAMES[i], s, p99);
+  }
+
+  pipecat_rtvi_send_client_message("frame-profile", data);
+  memset(stages, 0, sizeof(windows[window]));
+}
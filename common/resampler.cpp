@@ -0,0 +1,150 @@
+#include <esp_log.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+
+// Fraction of the lower Nyquist frequency kept by the anti-aliasing filter
+#define RESAMPLER_PASSBAND 0.9
+// Kaiser window shape, ~60 dB stopband
+#define RESAMPLER_KAISER_BETA 6.0
+
+// Rational L/M resampler. The prototype low-pass filter has `up` * `taps`
+// coefficients and is stored phase-major, so every output sample is a single
+// `taps` long dot product over the input history.
+struct pipecat_resampler {
+  int up;
+  int down;
+  int taps;
+  int16_t *coefs;
+  // The last `taps` - 1 input samples of the previous call, followed by room
+  // for the current input
+  int16_t *history;
+  size_t max_samples;
+  // Position of the next output sample in the upsampled domain, relative to
+  // the start of the current input
+  int acc;
+};
+
+static int gcd(int a, int b) {
+  while (b != 0) {
+    int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Zeroth order modified Bessel function of the first kind
+static double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 32; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+static void design_filter(pipecat_resampler_t *r) {
+  int length = r->up * r->taps;
+  double center = (length - 1) / 2.0;
+  // Cutoff relative to the upsampled rate
+  double cutoff =
+      RESAMPLER_PASSBAND * 0.5 / (r->up > r->down ? r->up : r->down);
+
+  for (int n = 0; n < length; n++) {
+    double t = n - center;
+    double sinc = t == 0.0 ? 2.0 * cutoff
+                           : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+    double ratio = t / (center + 1.0);
+    double window =
+        bessel_i0(RESAMPLER_KAISER_BETA * sqrt(1.0 - ratio * ratio)) /
+        bessel_i0(RESAMPLER_KAISER_BETA);
+    // Zero stuffing loses a factor of `up` in gain.
+    double h = sinc * window * r->up;
+
+    int phase = n % r->up;
+    int tap = n / r->up;
+    long q15 = lround(h * 32768.0);
+    r->coefs[phase * r->taps + tap] =
+        q15 > INT16_MAX ? INT16_MAX : (q15 < INT16_MIN ? INT16_MIN : q15);
+  }
+}
+
+pipecat_resampler_t *pipecat_resampler_create(int in_rate, int out_rate,
+                                              int taps, size_t max_samples) {
+  int g = gcd(in_rate, out_rate);
+  pipecat_resampler_t *r =
+      (pipecat_resampler_t *)calloc(1, sizeof(pipecat_resampler_t));
+  if (r == NULL) {
+    return NULL;
+  }
+
+  r->up = out_rate / g;
+  r->down = in_rate / g;
+  r->taps = taps;
+  r->max_samples = max_samples;
+  r->coefs = (int16_t *)malloc(r->up * taps * sizeof(int16_t));
+  r->history = (int16_t *)calloc(taps - 1 + max_samples, sizeof(int16_t));
+  if (r->coefs == NULL || r->history == NULL) {
+    ESP_LOGE(LOG_TAG, "Unable to allocate a %d -> %d Hz resampler", in_rate,
+             out_rate);
+    free(r->coefs);
+    free(r->history);
+    free(r);
+    return NULL;
+  }
+
+  design_filter(r);
+  ESP_LOGI(LOG_TAG, "Resampling %d -> %d Hz (%d/%d, %d taps per phase)",
+           in_rate, out_rate, r->up, r->down, taps);
+  return r;
+}
+
+size_t PIPECAT_AUDIO_IRAM pipecat_resampler_process(pipecat_resampler_t *r,
+                                                    const int16_t *in,
+                                                    size_t samples,
+                                                    int16_t *out) {
+  if (samples > r->max_samples) {
+    samples = r->max_samples;
+  }
+
+  // x[i] = history[taps - 1 + i], so x[-1] .. x[-(taps - 1)] is the tail of
+  // the previous input.
+  int16_t *x = r->history + r->taps - 1;
+  memcpy(x, in, samples * sizeof(int16_t));
+
+  size_t written = 0;
+  int end = samples * r->up;
+  while (r->acc < end) {
+    int position = r->acc / r->up;
+    const int16_t *h = r->coefs + (r->acc % r->up) * r->taps;
+    const int16_t *sample = x + position;
+
+    int32_t sum = 1 << 14;
+    for (int j = 0; j < r->taps; j++) {
+      sum += h[j] * sample[-j];
+    }
+    sum >>= 15;
+    out[written++] =
+        sum > INT16_MAX ? INT16_MAX : (sum < INT16_MIN ? INT16_MIN : sum);
+
+    r->acc += r->down;
+  }
+  r->acc -= end;
+
+  memmove(r->history, x + samples - (r->taps - 1),
+          (r->taps - 1) * sizeof(int16_t));
+  return written;
+}
+
+void pipecat_resampler_destroy(pipecat_resampler_t *r) {
+  if (r == NULL) {
+    return;
+  }
+  free(r->coefs);
+  free(r->history);
+  free(r);
+}
@@ -1,19 +1,23 @@
-#include <bsp/esp-bsp.h>
 #include <cJSON.h>
 #include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 #include <peer.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <atomic>
+
 #include "main.h"
 
 #define MAX_TYPE_LEN 32
 #define MAX_ID_LEN 64
 
 static int rtvi_id = 0;
-static QueueHandle_t rtvi_queue;
+static QueueHandle_t rtvi_queue = NULL;
 static PeerConnection *peer_connection = NULL;
 static rtvi_callbacks_t *rtvi_callbacks = NULL;
+static std::atomic<bool> rtvi_datachannel_open = false;
 
 typedef struct {
   cJSON *msg;
@@ -86,6 +90,9 @@ static void rtvi_handle_message(const rtvi_msg_t *msg) {
     case hash("bot-stopped-speaking"):
       rtvi_callbacks->on_bot_stopped_speaking();
       break;
+    case hash("user-started-speaking"):
+      rtvi_callbacks->on_user_started_speaking();
+      break;
     case hash("bot-tts-text"): {
       cJSON *j_data = cJSON_GetObjectItem(msg->msg, "data");
       cJSON *j_text = cJSON_GetObjectItem(j_data, "text");
@@ -102,6 +109,7 @@ static void rtvi_task(void *pvParameter) {
 
   while (1) {
     if (xQueueReceive(rtvi_queue, &msg, portMAX_DELAY)) {
+      PIPECAT_TRACE(PIPECAT_TRACE_QUEUE_RECEIVE, PIPECAT_TRACE_QUEUE_RTVI, 0);
       rtvi_handle_message(&msg);
       cJSON_Delete(msg.msg);
     }
@@ -114,14 +122,18 @@ void pipecat_init_rtvi(PeerConnection *connection,
   rtvi_callbacks = callbacks;
 
   rtvi_queue = xQueueCreate(10, sizeof(rtvi_msg_t));
-  xTaskCreatePinnedToCore(rtvi_task, "RTVI Task", 4096, NULL, 2, NULL, 1);
+  pipecat_task_create(PIPECAT_TASK_RTVI, rtvi_task, NULL);
 }
 
+// Called from the peer connection task once the RTVI data channel is created.
+void pipecat_rtvi_datachannel_opened() { rtvi_datachannel_open = true; }
+
 void pipecat_rtvi_send_client_ready() {
   rtvi_msg_t *msg = create_rtvi_message("client-ready");
 
   char *msg_str = rtvi_message_to_string(msg);
 
+  PIPECAT_TRACE(PIPECAT_TRACE_DATACHANNEL_SEND, 0, strlen(msg_str));
   peer_connection_datachannel_send(peer_connection, msg_str, strlen(msg_str));
 
   cJSON_free(msg_str);
@@ -129,7 +141,46 @@ void pipecat_rtvi_send_client_ready() {
   destroy_rtvi_message(msg);
 }
 
+// Sends `data` to the bot as a client message of type `t`, taking ownership
+// of it. Dropped until RTVI is initialized and its data channel is open.
+void pipecat_rtvi_send_client_message(const char *t, cJSON *data) {
+  if (peer_connection == NULL || !rtvi_datachannel_open) {
+    cJSON_Delete(data);
+    return;
+  }
+
+  rtvi_msg_t *msg = create_rtvi_message("client-message");
+  if (msg == NULL) {
+    cJSON_Delete(data);
+    return;
+  }
+
+  cJSON *j_data = cJSON_AddObjectToObject(msg->msg, "data");
+  if (j_data == NULL) {
+    cJSON_Delete(data);
+    destroy_rtvi_message(msg);
+    return;
+  }
+  cJSON_AddStringToObject(j_data, "t", t);
+  cJSON_AddItemToObject(j_data, "d", data);
+
+  char *msg_str = rtvi_message_to_string(msg);
+  if (msg_str != NULL) {
+    PIPECAT_TRACE(PIPECAT_TRACE_DATACHANNEL_SEND, 0, strlen(msg_str));
+    peer_connection_datachannel_send(peer_connection, msg_str,
+                                     strlen(msg_str));
+    cJSON_free(msg_str);
+  }
+
+  destroy_rtvi_message(msg);
+}
+
+// Messages that arrive before pipecat_init_rtvi are dropped.
 void pipecat_rtvi_handle_message(const char *msg) {
+  if (rtvi_queue == NULL) {
+    return;
+  }
+
   cJSON *j_msg = cJSON_Parse(msg);
   if (j_msg == NULL) {
     ESP_LOGE(LOG_TAG, "Error parsing RTVI message");
@@ -138,5 +189,6 @@ void pipecat_rtvi_handle_message(const char *msg) {
 
   rtvi_msg_t rtvi_msg = {.msg = j_msg};
 
+  PIPECAT_TRACE(PIPECAT_TRACE_QUEUE_SEND, PIPECAT_TRACE_QUEUE_RTVI, 0);
   xQueueSend(rtvi_queue, &rtvi_msg, portMAX_DELAY);
 }
@@ -0,0 +1,45 @@
+#include <esp_log.h>
+
+#include "main.h"
+
+#ifdef LINUX_BUILD
+// The Linux build has no screen and doesn't play audio, the bot's transcript
+// goes to the log.
+static void on_bot_started_speaking() {}
+
+static void on_bot_stopped_speaking() {}
+
+static void on_bot_tts_text(const char *text) {
+  ESP_LOGI(LOG_TAG, "Bot: %s", text);
+}
+
+static void on_user_started_speaking() {}
+#else
+static void on_bot_started_speaking() {
+  pipecat_screen_new_log();
+}
+
+static void on_bot_stopped_speaking() {
+  pipecat_screen_log("\n");
+}
+
+static void on_bot_tts_text(const char *text) {
+  pipecat_screen_log(text);
+  pipecat_screen_log(" ");
+}
+
+// The user barged in, the server has stopped the bot but the device may
+// still hold part of its answer.
+static void on_user_started_speaking() {
+  if (pipecat_audio_pending()) {
+    pipecat_audio_flush();
+  }
+}
+#endif
+
+rtvi_callbacks_t pipecat_rtvi_callbacks = {
+    .on_bot_started_speaking = on_bot_started_speaking,
+    .on_bot_stopped_speaking = on_bot_stopped_speaking,
+    .on_bot_tts_text = on_bot_tts_text,
+    .on_user_started_speaking = on_user_started_speaking,
+};
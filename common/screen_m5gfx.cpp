@@ -0,0 +1,272 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <string.h>
+
+#include "main.h"
+
+#define SCREEN_TICK_INTERVAL 50
+#define SCREEN_BRIGHTNESS 70
+#define SCREEN_BACKGROUND TFT_BLACK
+#define MAX_LOG_LINES 10
+#define MAX_LOG_LINE_LENGTH 512
+#define MAX_LOG_WORD_LENGTH 64
+#define LOG_LINE_SPACING 4
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+typedef struct {
+  char text[MAX_LOG_LINE_LENGTH];
+  size_t length;
+  uint32_t color;
+} log_line_t;
+
+static M5GFX *display = NULL;
+
+// The transcript is drawn into the back canvas while the front canvas keeps
+// what is currently on the panel. Only the rows that differ between the two
+// are pushed, with DMA, and then the canvases swap roles.
+static M5Canvas canvases[2];
+static int back_canvas = 0;
+
+static log_line_t log_lines[MAX_LOG_LINES];
+static int log_newest = -1;
+static int log_line_count = 0;
+static bool log_dirty = false;
+static SemaphoreHandle_t log_mutex = NULL;
+static TaskHandle_t screen_task_handle = NULL;
+
+// Must be called with `log_mutex` held.
+static log_line_t *new_log_line(uint32_t color) {
+  log_newest = (log_newest + 1) % MAX_LOG_LINES;
+  if (log_line_count < MAX_LOG_LINES) {
+    log_line_count++;
+  }
+
+  // Once the ring is full this reuses the oldest line.
+  log_line_t *line = &log_lines[log_newest];
+  line->text[0] = '\0';
+  line->length = 0;
+  line->color = color;
+  log_dirty = true;
+  return line;
+}
+
+// Must be called with `log_mutex` held.
+static void append_log_text(const char *text) {
+  if (log_line_count == 0) {
+    new_log_line(TFT_WHITE);
+  }
+
+  log_line_t *line = &log_lines[log_newest];
+  size_t len = strlen(text);
+  while (len > 0) {
+    size_t space = MAX_LOG_LINE_LENGTH - 1 - line->length;
+    if (space == 0) {
+      // Continue long transcripts on a new line with the same color.
+      line = new_log_line(line->color);
+      continue;
+    }
+
+    size_t copy_len = MIN(len, space);
+    memcpy(line->text + line->length, text, copy_len);
+    line->length += copy_len;
+    line->text[line->length] = '\0';
+    text += copy_len;
+    len -= copy_len;
+  }
+  log_dirty = true;
+}
+
+// Word-wraps `line` at the canvas width starting at row `y` and returns the
+// height it takes. Nothing is drawn when `draw` is false.
+static int layout_log_line(M5Canvas *canvas, const log_line_t *line, int y,
+                           bool draw) {
+  char word[MAX_LOG_WORD_LENGTH];
+  int font_height = canvas->fontHeight();
+  int width = canvas->width();
+  int height = font_height;
+  int x = 0;
+
+  const char *p = line->text;
+  while (*p) {
+    if (*p == '\n') {
+      p++;
+      if (*p) {
+        x = 0;
+        height += font_height;
+      }
+      continue;
+    }
+
+    // A word plus the spaces following it.
+    size_t word_len = strcspn(p, " \n");
+    size_t text_len = word_len + strspn(p + word_len, " ");
+    size_t copy_len = MIN(word_len, sizeof(word) - 1);
+    memcpy(word, p, copy_len);
+    word[copy_len] = '\0';
+
+    int word_width = canvas->textWidth(word);
+    if (x > 0 && x + word_width > width) {
+      x = 0;
+      height += font_height;
+    }
+
+    int row = y + height - font_height;
+    if (draw && row > -font_height && row < canvas->height()) {
+      canvas->drawString(word, x, row);
+    }
+    x += word_width + canvas->textWidth(" ") * (text_len - word_len);
+    p += text_len;
+  }
+
+  return height;
+}
+
+// Must be called with `log_mutex` held.
+static void render_log(M5Canvas *canvas) {
+  int oldest =
+      (log_newest - log_line_count + 1 + MAX_LOG_LINES) % MAX_LOG_LINES;
+
+  int total_height = 0;
+  for (int i = 0; i < log_line_count; ++i) {
+    log_line_t *line = &log_lines[(oldest + i) % MAX_LOG_LINES];
+    total_height += layout_log_line(canvas, line, 0, false) + LOG_LINE_SPACING;
+  }
+
+  // Keep the newest line at the bottom once the log overflows the screen.
+  int y = MIN(0, canvas->height() - total_height);
+
+  canvas->fillScreen(SCREEN_BACKGROUND);
+  for (int i = 0; i < log_line_count; ++i) {
+    log_line_t *line = &log_lines[(oldest + i) % MAX_LOG_LINES];
+    canvas->setTextColor(line->color, SCREEN_BACKGROUND);
+    y += layout_log_line(canvas, line, y, true) + LOG_LINE_SPACING;
+  }
+  log_dirty = false;
+}
+
+static void push_changed_rows(M5Canvas *back, M5Canvas *front) {
+  const uint16_t *back_buffer = (const uint16_t *)back->getBuffer();
+  const uint16_t *front_buffer = (const uint16_t *)front->getBuffer();
+  int width = back->width();
+  int height = back->height();
+  size_t row_size = width * sizeof(uint16_t);
+
+  int top = 0;
+  while (top < height && memcmp(back_buffer + top * width,
+                                front_buffer + top * width, row_size) == 0) {
+    top++;
+  }
+  if (top == height) {
+    return;
+  }
+
+  int bottom = height - 1;
+  while (bottom > top && memcmp(back_buffer + bottom * width,
+                                front_buffer + bottom * width, row_size) == 0) {
+    bottom--;
+  }
+
+  display->startWrite();
+  display->pushImageDMA(
+      0, top, width, bottom - top + 1,
+      (const lgfx::swap565_t *)(back_buffer + top * width));
+  display->endWrite();
+}
+
+static void invalidate_screen() {
+  if (screen_task_handle) {
+    xTaskNotifyGive(screen_task_handle);
+  }
+}
+
+// Sleeps until a log API invalidates the screen, then coalesces every update
+// made since into a single frame. At most one frame is pushed per
+// SCREEN_TICK_INTERVAL.
+static void screen_task(void *pvParameter) {
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    if (log_dirty) {
+      M5Canvas *back = &canvases[back_canvas];
+      M5Canvas *front = &canvases[back_canvas ^ 1];
+
+      int64_t start_us = esp_timer_get_time();
+      xSemaphoreTake(log_mutex, portMAX_DELAY);
+      render_log(back);
+      xSemaphoreGive(log_mutex);
+
+      push_changed_rows(back, front);
+      back_canvas ^= 1;
+      ESP_LOGD(LOG_TAG, "Screen frame rendered in %lld us",
+               esp_timer_get_time() - start_us);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(SCREEN_TICK_INTERVAL));
+  }
+}
+
+void pipecat_init_screen() {
+  log_mutex = xSemaphoreCreateMutex();
+
+  display = pipecat_board_init_display();
+  if (display == NULL) {
+    ESP_LOGE(LOG_TAG, "Failed to initialize display");
+    return;
+  }
+  display->setBrightness(SCREEN_BRIGHTNESS);
+  display->fillScreen(SCREEN_BACKGROUND);
+
+  for (auto &canvas : canvases) {
+    canvas.setPsram(true);
+    canvas.setColorDepth(16);
+    canvas.setTextSize(board_traits::screen_text_size);
+    canvas.setTextWrap(false);
+    if (canvas.createSprite(display->width(), display->height()) == nullptr) {
+      ESP_LOGE(LOG_TAG, "Failed to allocate screen canvas");
+      return;
+    }
+    canvas.fillScreen(SCREEN_BACKGROUND);
+  }
+
+  screen_task_handle =
+      pipecat_task_create(PIPECAT_TASK_SCREEN, screen_task, NULL);
+
+  ESP_LOGI(LOG_TAG, "Display initialized");
+}
+
+void pipecat_screen_system_log(const char *text) {
+  if (!screen_task_handle) {
+    return;
+  }
+
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  new_log_line(TFT_WHITE);
+  append_log_text(text);
+  xSemaphoreGive(log_mutex);
+  invalidate_screen();
+}
+
+void pipecat_screen_new_log() {
+  if (!screen_task_handle) {
+    return;
+  }
+
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  new_log_line(TFT_CYAN);
+  xSemaphoreGive(log_mutex);
+  invalidate_screen();
+}
+
+void pipecat_screen_log(const char *text) {
+  if (!screen_task_handle) {
+    return;
+  }
+
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  append_log_text(text);
+  xSemaphoreGive(log_mutex);
+  invalidate_screen();
+}
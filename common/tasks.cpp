@@ -0,0 +1,229 @@
+#include <esp_log.h>
+#include <stdlib.h>
+
+#include "main.h"
+
+#ifdef LINUX_BUILD
+// Only the signalling task runs in the Linux build, the audio entries are
+// placeholders.
+#define AUDIO_TASK_PRIORITY 7
+#define AUDIO_TASK_STACK_SIZE 30000
+#define AUDIO_TASK_STACK_CAPS 0
+#else
+#include <esp_heap_caps.h>
+
+#define AUDIO_TASK_PRIORITY board_traits::send_task_priority
+#define AUDIO_TASK_STACK_SIZE board_traits::send_task_stack_size
+#define AUDIO_TASK_STACK_CAPS board_traits::send_task_stack_caps
+#endif
+#define DEFAULT_STACK_CAPS 0
+
+// Minimum time between two CPU usage reports
+#define TASK_REPORT_INTERVAL_MS 10000
+// Tasks whose run time is remembered from one report to the next
+#define TASK_REPORT_MAX_TASKS 32
+// Minimum time between two memory profile reports
+#define MEMORY_REPORT_INTERVAL_MS 30000
+// Recommended stacks leave a quarter of headroom over the deepest use seen,
+// rounded up to whole kilobytes
+#define STACK_HEADROOM_SHIFT 2
+#define STACK_ROUNDING 1024
+
+// Where every task of the client runs. Core 0 carries the Wi-Fi driver and
+// the encoder, core 1 the decoder, playback and everything else.
+static const pipecat_task_config_t TASK_SCHEDULE[PIPECAT_TASK_COUNT] = {
+    // name, core, priority, stack size, stack caps
+    {"boot_wifi", 0, 5, 8192, DEFAULT_STACK_CAPS},
+    {"boot_display", 1, 5, 8192, DEFAULT_STACK_CAPS},
+    {"boot_media", 1, 5, 8192, DEFAULT_STACK_CAPS},
+    {"signalling", 1, 5, 12288, DEFAULT_STACK_CAPS},
+    {"audio_publisher", 0, AUDIO_TASK_PRIORITY, AUDIO_TASK_STACK_SIZE,
+     AUDIO_TASK_STACK_CAPS},
+    {"audio_decoder", 1, AUDIO_TASK_PRIORITY, 16384, AUDIO_TASK_STACK_CAPS},
+    {"play_task", 1, 5, 4096, DEFAULT_STACK_CAPS},
+    {"RTVI Task", 1, 2, 4096, DEFAULT_STACK_CAPS},
+    {"Screen Task", 1, 1, 4096, DEFAULT_STACK_CAPS},
+    {"taskLVGL", 1, 1, 7168, DEFAULT_STACK_CAPS},
+    {"trace_dump", 1, 1, 4096, DEFAULT_STACK_CAPS},
+};
+
+// Running tasks, and the least free stack of the ones that have exited
+static TaskHandle_t task_handles[PIPECAT_TASK_COUNT];
+static uint32_t exit_stack_free[PIPECAT_TASK_COUNT];
+
+const pipecat_task_config_t *pipecat_task_config(pipecat_task_t task) {
+  return &TASK_SCHEDULE[task];
+}
+
+TaskHandle_t pipecat_task_create(pipecat_task_t task, TaskFunction_t function,
+                                 void *arg) {
+  const pipecat_task_config_t *config = &TASK_SCHEDULE[task];
+  TaskHandle_t handle = NULL;
+  BaseType_t created;
+#ifdef LINUX_BUILD
+  created = xTaskCreatePinnedToCore(function, config->name, config->stack_size,
+                                    arg, config->priority, &handle,
+                                    config->core);
+#else
+  if (config->stack_caps == DEFAULT_STACK_CAPS) {
+    created = xTaskCreatePinnedToCore(function, config->name,
+                                      config->stack_size, arg,
+                                      config->priority, &handle, config->core);
+  } else {
+    created = xTaskCreatePinnedToCoreWithCaps(
+        function, config->name, config->stack_size, arg, config->priority,
+        &handle, config->core, config->stack_caps);
+  }
+#endif
+
+  if (created != pdPASS) {
+    ESP_LOGE(LOG_TAG, "Failed to start %s", config->name);
+    return NULL;
+  }
+  task_handles[task] = handle;
+  return handle;
+}
+
+// Ends the calling task, keeping its stack high water mark for the memory
+// profile.
+void pipecat_task_exit(pipecat_task_t task) {
+#ifndef LINUX_BUILD
+  exit_stack_free[task] = uxTaskGetStackHighWaterMark(NULL);
+#endif
+  task_handles[task] = NULL;
+  vTaskDelete(NULL);
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && \
+    CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+static TickType_t last_report = 0;
+static TaskHandle_t previous_handles[TASK_REPORT_MAX_TASKS];
+static configRUN_TIME_COUNTER_TYPE previous_counters[TASK_REPORT_MAX_TASKS];
+static configRUN_TIME_COUNTER_TYPE previous_total = 0;
+static int previous_count = 0;
+
+static configRUN_TIME_COUNTER_TYPE previous_counter(TaskHandle_t handle) {
+  for (int i = 0; i < previous_count; i++) {
+    if (previous_handles[i] == handle) {
+      return previous_counters[i];
+    }
+  }
+  return 0;
+}
+
+// Logs the share of one core every task used since the previous report, with
+// its placement and the least stack it had left. Called from the main loop,
+// rate limited to TASK_REPORT_INTERVAL_MS.
+void pipecat_task_report() {
+  TickType_t now = xTaskGetTickCount();
+  if (now - last_report < pdMS_TO_TICKS(TASK_REPORT_INTERVAL_MS)) {
+    return;
+  }
+  last_report = now;
+
+  UBaseType_t count = uxTaskGetNumberOfTasks();
+  TaskStatus_t *tasks = (TaskStatus_t *)malloc(count * sizeof(TaskStatus_t));
+  if (tasks == NULL) {
+    return;
+  }
+
+  configRUN_TIME_COUNTER_TYPE total;
+  count = uxTaskGetSystemState(tasks, count, &total);
+  configRUN_TIME_COUNTER_TYPE elapsed = total - previous_total;
+  if (elapsed == 0) {
+    free(tasks);
+    return;
+  }
+
+  ESP_LOGI(LOG_TAG, "%-16s %4s %4s %6s %10s", "Task", "Core", "Prio", "CPU",
+           "Stack free");
+  for (UBaseType_t i = 0; i < count; i++) {
+    configRUN_TIME_COUNTER_TYPE used =
+        tasks[i].ulRunTimeCounter - previous_counter(tasks[i].xHandle);
+    BaseType_t core = xTaskGetCoreID(tasks[i].xHandle);
+    ESP_LOGI(LOG_TAG, "%-16s %4s %4u %5.1f%% %10lu", tasks[i].pcTaskName,
+             core == tskNO_AFFINITY ? "any" : (core == 0 ? "0" : "1"),
+             (unsigned)tasks[i].uxCurrentPriority, 100.0f * used / elapsed,
+             (unsigned long)tasks[i].usStackHighWaterMark);
+  }
+
+  previous_count = 0;
+  for (UBaseType_t i = 0; i < count && i < TASK_REPORT_MAX_TASKS; i++) {
+    previous_handles[previous_count] = tasks[i].xHandle;
+    previous_counters[previous_count] = tasks[i].ulRunTimeCounter;
+    previous_count++;
+  }
+  previous_total = total;
+  free(tasks);
+}
+#else
+void pipecat_task_report() {
+  static bool warned = false;
+  if (!warned) {
+    ESP_LOGW(LOG_TAG,
+             "Task report needs CONFIG_FREERTOS_USE_TRACE_FACILITY and "
+             "CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS");
+    warned = true;
+  }
+}
+#endif
+
+#ifndef LINUX_BUILD
+static void report_heap(const char *name, uint32_t caps) {
+  size_t total = heap_caps_get_total_size(caps);
+  if (total == 0) {
+    return;
+  }
+  size_t free_size = heap_caps_get_free_size(caps);
+  size_t minimum = heap_caps_get_minimum_free_size(caps);
+  ESP_LOGI(LOG_TAG, "Heap %-8s %7u total %7u used %7u peak %7u largest",
+           name, (unsigned)total, (unsigned)(total - free_size),
+           (unsigned)(total - minimum),
+           (unsigned)heap_caps_get_largest_free_block(caps));
+}
+
+// Logs the deepest stack use of every task in the schedule with a
+// recommended size, and the current and peak use of every heap. Called from
+// the main loop, rate limited to MEMORY_REPORT_INTERVAL_MS; the numbers are
+// only meaningful after a full conversation.
+void pipecat_memory_report() {
+  static TickType_t last_report = 0;
+  TickType_t now = xTaskGetTickCount();
+  if (now - last_report < pdMS_TO_TICKS(MEMORY_REPORT_INTERVAL_MS)) {
+    return;
+  }
+  last_report = now;
+
+  ESP_LOGI(LOG_TAG, "%-16s %6s %6s %6s %s", "Task", "Stack", "Used",
+           "Advise", "Caps");
+  for (int i = 0; i < PIPECAT_TASK_COUNT; i++) {
+    const pipecat_task_config_t *config = &TASK_SCHEDULE[i];
+    TaskHandle_t handle = task_handles[i];
+    if (handle == NULL && exit_stack_free[i] == 0) {
+      // Started by a library, e.g. LVGL's task.
+      handle = xTaskGetHandle(config->name);
+    }
+
+    uint32_t stack_free;
+    if (handle != NULL) {
+      stack_free = uxTaskGetStackHighWaterMark(handle);
+    } else if (exit_stack_free[i] != 0) {
+      stack_free = exit_stack_free[i];
+    } else {
+      continue;
+    }
+
+    uint32_t used = config->stack_size - stack_free;
+    uint32_t advised = used + (used >> STACK_HEADROOM_SHIFT);
+    advised = (advised + STACK_ROUNDING - 1) / STACK_ROUNDING * STACK_ROUNDING;
+    ESP_LOGI(LOG_TAG, "%-16s %6lu %6lu %6lu %s", config->name,
+             (unsigned long)config->stack_size, (unsigned long)used,
+             (unsigned long)advised,
+             (config->stack_caps & MALLOC_CAP_SPIRAM) ? "SPIRAM" : "internal");
+  }
+
+  report_heap("internal", MALLOC_CAP_INTERNAL);
+  report_heap("DMA", MALLOC_CAP_DMA);
+  report_heap("SPIRAM", MALLOC_CAP_SPIRAM);
+}
+#endif
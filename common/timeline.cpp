@@ -0,0 +1,72 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "main.h"
+
+#define TIMELINE_REPORT_SIZE 1024
+
+static const char *PHASE_NAMES[PIPECAT_PHASE_COUNT] = {
+    "NVS init",
+    "Display init",
+    "Codec init",
+    "Wi-Fi associated",
+    "Wi-Fi got IP",
+    "Create offer",
+    "ICE gathering complete",
+    "HTTP answer received",
+    "ICE connected",
+    "First secure data",
+    "DataChannel open",
+    "First RTP sent",
+    "First RTP received",
+};
+
+static int64_t phase_times[PIPECAT_PHASE_COUNT];
+static bool timeline_reported = false;
+
+void pipecat_timeline_mark(pipecat_phase_t phase) {
+  // Only the first occurrence of a phase is kept.
+  if (phase_times[phase] == 0) {
+    phase_times[phase] = esp_timer_get_time();
+  }
+}
+
+void pipecat_timeline_report() {
+  if (timeline_reported || phase_times[PIPECAT_PHASE_FIRST_AUDIO_SENT] == 0 ||
+      phase_times[PIPECAT_PHASE_FIRST_AUDIO_RECEIVED] == 0) {
+    return;
+  }
+  timeline_reported = true;
+
+  char report[TIMELINE_REPORT_SIZE];
+  int len = snprintf(report, sizeof(report), "Connection timeline:");
+
+  int64_t previous = 0;
+  for (int i = 0; i < PIPECAT_PHASE_COUNT && len < (int)sizeof(report); ++i) {
+    if (phase_times[i] == 0) {
+      len += snprintf(report + len, sizeof(report) - len, "\n  %-24s      -",
+                      PHASE_NAMES[i]);
+      continue;
+    }
+
+    len += snprintf(report + len, sizeof(report) - len,
+                    "\n  %-24s %6" PRId64 " ms (+%" PRId64 " ms)",
+                    PHASE_NAMES[i], phase_times[i] / 1000,
+                    (phase_times[i] - previous) / 1000);
+    previous = phase_times[i];
+  }
+
+  if (phase_times[PIPECAT_PHASE_ANSWER_RECEIVED] != 0 &&
+      phase_times[PIPECAT_PHASE_ICE_GATHERED] != 0 &&
+      len < (int)sizeof(report)) {
+    snprintf(report + len, sizeof(report) - len,
+             "\n  HTTP POST round trip: %" PRId64 " ms",
+             (phase_times[PIPECAT_PHASE_ANSWER_RECEIVED] -
+              phase_times[PIPECAT_PHASE_ICE_GATHERED]) /
+                 1000);
+  }
+
+  ESP_LOGI(LOG_TAG, "%s", report);
+}
@@ -0,0 +1,188 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "main.h"
+
+#ifdef LINUX_BUILD
+#define TRACE_CORES 1
+#define TRACE_CORE_ID() 0
+#define TRACE_IRAM
+#else
+#include <esp_attr.h>
+#include <esp_cpu.h>
+
+#define TRACE_CORES portNUM_PROCESSORS
+#define TRACE_CORE_ID() esp_cpu_get_core_id()
+// Task switches are recorded from the scheduler, which also runs while the
+// flash cache is disabled.
+#define TRACE_IRAM IRAM_ATTR
+#endif
+
+// Events kept per core, the oldest are overwritten
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS 1024
+#endif
+static_assert((TRACE_RING_EVENTS & (TRACE_RING_EVENTS - 1)) == 0,
+              "TRACE_RING_EVENTS must be a power of two");
+// Time between two dumps when nothing triggers one
+#define TRACE_DUMP_INTERVAL_MS 60000
+// Minimum time between two dumps
+#define TRACE_DUMP_HOLDOFF_MS 5000
+// How often the dump task looks for a trigger
+#define TRACE_POLL_MS 100
+// Events per line of a dump
+#define TRACE_DUMP_LINE_EVENTS 16
+// Bumped whenever the layout of trace_record_t changes, see
+// tools/trace_to_chrome.py
+#define TRACE_FORMAT_VERSION 1
+
+// 12 bytes, little endian, read as "<IBBHI" by the converter
+typedef struct __attribute__((packed)) {
+  uint32_t time_us;
+  uint8_t event;
+  uint8_t reserved;
+  uint16_t size;
+  uint32_t id;
+} trace_record_t;
+
+// Every core writes its own pair of rings, one recording while the dump task
+// reads the other. Slots are claimed with an atomic increment, so a task, the
+// scheduler and interrupts on the same core never wait on each other.
+typedef struct {
+  trace_record_t records[TRACE_RING_EVENTS];
+  std::atomic<uint32_t> head;
+  // Writes in progress, the dump task waits for them to drain after a swap
+  std::atomic<uint32_t> writers;
+} trace_ring_t;
+
+static trace_ring_t rings[TRACE_CORES][2];
+static std::atomic<int> active_ring[TRACE_CORES];
+static std::atomic<bool> triggered = false;
+
+void TRACE_IRAM pipecat_trace(pipecat_trace_event_t event, uint32_t id,
+                              uint32_t size) {
+  int core = TRACE_CORE_ID();
+  trace_ring_t *ring;
+  while (true) {
+    int active = active_ring[core].load();
+    ring = &rings[core][active];
+    ring->writers.fetch_add(1);
+    // A swap between the load and the increment may not have seen this
+    // writer, move over to the new ring.
+    if (active_ring[core].load() == active) {
+      break;
+    }
+    ring->writers.fetch_sub(1);
+  }
+
+  uint32_t slot = ring->head.fetch_add(1, std::memory_order_relaxed);
+  trace_record_t *record = &ring->records[slot & (TRACE_RING_EVENTS - 1)];
+  record->time_us = (uint32_t)esp_timer_get_time();
+  record->event = event;
+  record->reserved = 0;
+  record->size = size > UINT16_MAX ? UINT16_MAX : size;
+  record->id = id;
+  ring->writers.fetch_sub(1, std::memory_order_release);
+
+  // A drop is the glitch the trace is for, keep what led up to it.
+  if (event == PIPECAT_TRACE_QUEUE_DROP) {
+    triggered.store(true, std::memory_order_relaxed);
+  }
+}
+
+// Called by FreeRTOS on every context switch, see trace_hooks.h.
+extern "C" void TRACE_IRAM pipecat_trace_task_switched_in(void *task) {
+  pipecat_trace(PIPECAT_TRACE_TASK_SWITCH, (uint32_t)(uintptr_t)task, 0);
+}
+
+static void dump_task_names() {
+#if !defined(LINUX_BUILD) && CONFIG_FREERTOS_USE_TRACE_FACILITY
+  UBaseType_t count = uxTaskGetNumberOfTasks();
+  TaskStatus_t *tasks = (TaskStatus_t *)malloc(count * sizeof(TaskStatus_t));
+  if (tasks == NULL) {
+    return;
+  }
+  count = uxTaskGetSystemState(tasks, count, NULL);
+  for (UBaseType_t i = 0; i < count; i++) {
+    ESP_LOGI(LOG_TAG, "TRACE TASK %08lx %s",
+             (unsigned long)(uintptr_t)tasks[i].xHandle, tasks[i].pcTaskName);
+  }
+  free(tasks);
+#endif
+}
+
+static void dump_ring(int core, const trace_ring_t *ring) {
+  static const char HEX[] = "0123456789abcdef";
+  char line[TRACE_DUMP_LINE_EVENTS * sizeof(trace_record_t) * 2 + 1];
+
+  uint32_t head = ring->head.load(std::memory_order_relaxed);
+  uint32_t count = head < TRACE_RING_EVENTS ? head : TRACE_RING_EVENTS;
+  for (uint32_t done = 0; done < count;) {
+    size_t length = 0;
+    for (int i = 0; i < TRACE_DUMP_LINE_EVENTS && done < count; i++, done++) {
+      uint32_t slot = head - count + done;
+      const uint8_t *bytes =
+          (const uint8_t *)&ring->records[slot & (TRACE_RING_EVENTS - 1)];
+      for (size_t b = 0; b < sizeof(trace_record_t); b++) {
+        line[length++] = HEX[bytes[b] >> 4];
+        line[length++] = HEX[bytes[b] & 0xf];
+      }
+    }
+    line[length] = '\0';
+    ESP_LOGI(LOG_TAG, "TRACE EVENTS %d %s", core, line);
+  }
+}
+
+// Swaps every core over to its other ring and prints the one it was
+// recording, oldest event first, for tools/trace_to_chrome.py. Recording goes
+// on meanwhile.
+static void dump() {
+  trace_ring_t *dumped[TRACE_CORES];
+  for (int core = 0; core < TRACE_CORES; core++) {
+    int active = active_ring[core].load();
+    active_ring[core].store(!active);
+    dumped[core] = &rings[core][active];
+  }
+  // A write that claimed a slot before the swap finishes within microseconds,
+  // unless its task was preempted.
+  for (int core = 0; core < TRACE_CORES; core++) {
+    while (dumped[core]->writers.load() != 0) {
+      vTaskDelay(1);
+    }
+  }
+
+  ESP_LOGI(LOG_TAG, "TRACE BEGIN %d %d", TRACE_FORMAT_VERSION, TRACE_CORES);
+  dump_task_names();
+  for (int core = 0; core < TRACE_CORES; core++) {
+    dump_ring(core, dumped[core]);
+    dumped[core]->head = 0;
+  }
+  ESP_LOGI(LOG_TAG, "TRACE END");
+}
+
+// Dumps the rings after a queue drop, or every TRACE_DUMP_INTERVAL_MS. Runs at
+// a low priority, so that printing a dump never holds up the peer connection
+// loop or the audio tasks.
+static void trace_task(void *user_data) {
+  TickType_t last_dump = xTaskGetTickCount();
+  while (1) {
+    vTaskDelay(pdMS_TO_TICKS(TRACE_POLL_MS));
+    TickType_t since = xTaskGetTickCount() - last_dump;
+    if (since < pdMS_TO_TICKS(TRACE_DUMP_HOLDOFF_MS) ||
+        (since < pdMS_TO_TICKS(TRACE_DUMP_INTERVAL_MS) && !triggered)) {
+      continue;
+    }
+    last_dump = xTaskGetTickCount();
+    triggered = false;
+    dump();
+  }
+}
+
+void pipecat_init_trace() {
+  pipecat_task_create(PIPECAT_TASK_TRACE, trace_task, NULL);
+}
@@ -0,0 +1,17 @@
+// Force-included into every source file of the build with EVENT_TRACE, see
+// pipecat.cmake, so that FreeRTOS picks up the tracer's hooks before it
+// falls back to its empty defaults.
+#pragma once
+
+#ifndef __ASSEMBLER__
+#ifdef __cplusplus
+extern "C" {
+#endif
+void pipecat_trace_task_switched_in(void *task);
+#ifdef __cplusplus
+}
+#endif
+
+#define traceTASK_SWITCHED_IN() \
+  pipecat_trace_task_switched_in(xTaskGetCurrentTaskHandle())
+#endif
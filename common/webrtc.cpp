@@ -7,34 +7,28 @@
 #include <esp_log.h>
 #include <string.h>
 
+#include <atomic>
+
 #include "main.h"
 
 static PeerConnection *peer_connection = NULL;
+static std::atomic<char *> pending_answer = NULL;
 
 #ifndef LINUX_BUILD
-StaticTask_t task_buffer;
-
-// Pre-allocate buffer to avoid malloc in critical path
-static char *http_response_buffer = NULL;
-
 void pipecat_send_audio_task(void *user_data) {
-  pipecat_init_audio_encoder();
-  
-  // Set high priority and pin to core for consistent timing
-  vTaskPrioritySet(NULL, configMAX_PRIORITIES - 2);
-  
   TickType_t last_wake_time = xTaskGetTickCount();
-  const TickType_t frequency = pdMS_TO_TICKS(TICK_INTERVAL);
-
   while (1) {
-    vTaskDelayUntil(&last_wake_time, frequency); // More precise timing
+    PIPECAT_TRACE(PIPECAT_TRACE_FRAME_BEGIN, PIPECAT_TRACE_FRAME_CAPTURE, 0);
     pipecat_send_audio(peer_connection);
+    PIPECAT_TRACE(PIPECAT_TRACE_FRAME_END, PIPECAT_TRACE_FRAME_CAPTURE, 0);
+    vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(TICK_INTERVAL));
   }
 }
 #endif
 
 static void pipecat_ondatachannel_onmessage_task(char *msg, size_t len,
                                                  void *userdata, uint16_t sid) {
+  PIPECAT_TRACE(PIPECAT_TRACE_DATACHANNEL_RECEIVE, sid, len);
 #ifdef LOG_DATACHANNEL_MESSAGES
   ESP_LOGI(LOG_TAG, "DataChannel Message: %s", msg);
 #endif
@@ -42,10 +36,14 @@ static void pipecat_ondatachannel_onmessage_task(char *msg, size_t len,
 }
 
 static void pipecat_ondatachannel_onopen_task(void *userdata) {
+  pipecat_timeline_mark(PIPECAT_PHASE_FIRST_SECURE_DATA);
+  pipecat_timeline_mark(PIPECAT_PHASE_DATACHANNEL_OPEN);
+
   if (peer_connection_create_datachannel(peer_connection, DATA_CHANNEL_RELIABLE,
                                          0, 0, (char *)"rtvi-ai",
                                          (char *)"") != -1) {
     ESP_LOGI(LOG_TAG, "DataChannel created");
+    pipecat_rtvi_datachannel_opened();
   } else {
     ESP_LOGE(LOG_TAG, "Failed to create DataChannel");
   }
@@ -59,44 +57,53 @@ static void pipecat_onconnectionstatechange_task(PeerConnectionState state,
   if (state == PEER_CONNECTION_DISCONNECTED ||
       state == PEER_CONNECTION_CLOSED) {
 #ifndef LINUX_BUILD
-    // Clean shutdown before restart
-    if (http_response_buffer) {
-      heap_caps_free(http_response_buffer);
-      http_response_buffer = NULL;
-    }
     esp_restart();
 #endif
   } else if (state == PEER_CONNECTION_CONNECTED) {
+    pipecat_timeline_mark(PIPECAT_PHASE_ICE_CONNECTED);
 #ifndef LINUX_BUILD
-    // Pre-allocate HTTP buffer to avoid malloc during critical operations
-    if (!http_response_buffer) {
-      http_response_buffer = (char *)heap_caps_malloc(MAX_HTTP_OUTPUT_BUFFER + 1, MALLOC_CAP_DMA);
-    }
-    
-    // Use DMA memory for task stack for better performance
-    StackType_t *stack_memory = (StackType_t *)heap_caps_malloc(
-        25000 * sizeof(StackType_t), MALLOC_CAP_DMA); // Reduced stack size
-    
-    // Pin audio task to core 0 (opposite of WiFi core) for better isolation
-    xTaskCreateStaticPinnedToCore(pipecat_send_audio_task, "audio_pub",
-                                  25000, NULL, configMAX_PRIORITIES - 2, 
-                                  stack_memory, &task_buffer, 0);
+    pipecat_task_create(PIPECAT_TASK_AUDIO_SEND, pipecat_send_audio_task,
+                        NULL);
+#endif
     pipecat_init_rtvi(peer_connection, &pipecat_rtvi_callbacks);
+  }
+}
+
+// Runs the HTTP offer/answer exchange off the main task, so the rest of the
+// boot keeps going during the round trip. The answer is applied from
+// pipecat_webrtc_loop, on the task that owns the peer connection.
+static void pipecat_signalling_task(void *user_data) {
+  char *offer = (char *)user_data;
+  char *answer = pipecat_http_request(offer);
+  free(offer);
+  pipecat_timeline_mark(PIPECAT_PHASE_ANSWER_RECEIVED);
+
+  if (answer == NULL) {
+    ESP_LOGE(LOG_TAG, "Failed to exchange SDP with %s",
+             PIPECAT_SMALLWEBRTC_URL);
+#ifndef LINUX_BUILD
+    esp_restart();
 #endif
+  } else {
+    pending_answer = answer;
   }
+  pipecat_task_exit(PIPECAT_TASK_SIGNALLING);
 }
 
+// No ICE servers are configured, so libpeer only gathers host candidates and
+// the offer can go out as soon as they exist.
 static void pipecat_on_icecandidate_task(char *description, void *user_data) {
-  // Use pre-allocated buffer instead of malloc
-  if (!http_response_buffer) {
-    http_response_buffer = (char *)heap_caps_malloc(MAX_HTTP_OUTPUT_BUFFER + 1, MALLOC_CAP_DMA);
+  pipecat_timeline_mark(PIPECAT_PHASE_ICE_GATHERED);
+
+  char *offer = strdup(description);
+  if (offer == NULL || pipecat_task_create(PIPECAT_TASK_SIGNALLING,
+                                           pipecat_signalling_task,
+                                           offer) == NULL) {
+    ESP_LOGE(LOG_TAG, "Failed to start signalling");
+#ifndef LINUX_BUILD
+    esp_restart();
+#endif
   }
-  
-  memset(http_response_buffer, 0, MAX_HTTP_OUTPUT_BUFFER + 1);
-  pipecat_http_request(description, http_response_buffer);
-  peer_connection_set_remote_description(peer_connection, http_response_buffer,
-                                         SDP_TYPE_ANSWER);
-  // Don't free - keep buffer allocated for reuse
 }
 
 void pipecat_init_webrtc() {
@@ -107,7 +114,8 @@ void pipecat_init_webrtc() {
       .datachannel = DATA_CHANNEL_STRING,
       .onaudiotrack = [](uint8_t *data, size_t size, void *userdata) -> void {
 #ifndef LINUX_BUILD
-        // Process audio on same core to reduce context switching
+        pipecat_timeline_mark(PIPECAT_PHASE_FIRST_SECURE_DATA);
+        pipecat_timeline_mark(PIPECAT_PHASE_FIRST_AUDIO_RECEIVED);
         pipecat_audio_decode(data, size);
 #endif
       },
@@ -130,18 +138,23 @@ void pipecat_init_webrtc() {
   peer_connection_ondatachannel(peer_connection,
                                 pipecat_ondatachannel_onmessage_task,
                                 pipecat_ondatachannel_onopen_task, NULL);
+}
 
+void pipecat_webrtc_connect() {
+  pipecat_timeline_mark(PIPECAT_PHASE_CREATE_OFFER);
   peer_connection_create_offer(peer_connection);
 }
 
 void pipecat_webrtc_loop() {
+  char *answer = pending_answer.exchange(NULL);
+  if (answer != NULL) {
+    peer_connection_set_remote_description(peer_connection, answer,
+                                           SDP_TYPE_ANSWER);
+    free(answer);
+  }
+
+  PIPECAT_TRACE(PIPECAT_TRACE_PEER_LOOP_BEGIN, 0, 0);
   peer_connection_loop(peer_connection);
+  PIPECAT_TRACE(PIPECAT_TRACE_PEER_LOOP_END, 0, 0);
+  pipecat_timeline_report();
 }
-
-// Cleanup function
-void pipecat_webrtc_cleanup() {
-  if (http_response_buffer) {
-    heap_caps_free(http_response_buffer);
-    http_response_buffer = NULL;
-  }
-}
\ No newline at end of file
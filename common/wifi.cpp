@@ -0,0 +1,220 @@
+#include <assert.h>
+#include <esp_event.h>
+#include <esp_log.h>
+#include <esp_netif.h>
+#include <esp_wifi.h>
+#include <freertos/event_groups.h>
+#include <nvs.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+
+#define WIFI_MAX_RETRIES 5
+#define WIFI_DIRECTED_TIMEOUT_MS 3000
+#define WIFI_DISCONNECT_TIMEOUT_MS 1000
+#define WIFI_NVS_NAMESPACE "wifi"
+#define WIFI_NVS_AP_KEY "ap"
+
+#define WIFI_ASSOCIATED_BIT BIT0
+#define WIFI_GOT_IP_BIT BIT1
+#define WIFI_FAIL_BIT BIT2
+
+// The AP of the last session that got an address. The next boot associates
+// with it directly instead of scanning every channel.
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t channel;
+} wifi_cached_ap_t;
+
+static EventGroupHandle_t wifi_event_group = NULL;
+static bool wifi_directed = false;
+static int s_retry_num = 0;
+
+static void pipecat_event_handler(void *arg, esp_event_base_t event_base,
+                                  int32_t event_id, void *event_data) {
+  if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+    xEventGroupClearBits(wifi_event_group,
+                         WIFI_ASSOCIATED_BIT | WIFI_GOT_IP_BIT);
+    // A directed association is tried only once, the full scan fallback is
+    // started by pipecat_init_wifi.
+    if (!wifi_directed && s_retry_num < WIFI_MAX_RETRIES) {
+      esp_wifi_connect();
+      s_retry_num++;
+      ESP_LOGI(LOG_TAG, "retry to connect to the AP");
+      return;
+    }
+    ESP_LOGI(LOG_TAG, "connect to the AP fail");
+    xEventGroupSetBits(wifi_event_group, WIFI_FAIL_BIT);
+  } else if (event_base == WIFI_EVENT &&
+             event_id == WIFI_EVENT_STA_CONNECTED) {
+    pipecat_timeline_mark(PIPECAT_PHASE_WIFI_ASSOCIATED);
+    xEventGroupSetBits(wifi_event_group, WIFI_ASSOCIATED_BIT);
+  } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+    pipecat_timeline_mark(PIPECAT_PHASE_WIFI_GOT_IP);
+    ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+    ESP_LOGI(LOG_TAG, "got ip:" IPSTR, IP2STR(&event->ip_info.ip));
+    // The association is up, a later disconnect takes the retry path even if
+    // it came from the cached AP.
+    wifi_directed = false;
+    s_retry_num = 0;
+    xEventGroupSetBits(wifi_event_group, WIFI_GOT_IP_BIT);
+  }
+}
+
+static bool pipecat_wifi_load_ap(wifi_cached_ap_t *ap) {
+  nvs_handle_t handle;
+  if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+    return false;
+  }
+
+  size_t size = sizeof(wifi_cached_ap_t);
+  esp_err_t err = nvs_get_blob(handle, WIFI_NVS_AP_KEY, ap, &size);
+  nvs_close(handle);
+  return err == ESP_OK && size == sizeof(wifi_cached_ap_t);
+}
+
+// Stores `ap`, or forgets the cached AP when it is NULL.
+static void pipecat_wifi_store_ap(const wifi_cached_ap_t *ap) {
+  nvs_handle_t handle;
+  if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+    ESP_LOGW(LOG_TAG, "Unable to open NVS to cache the AP");
+    return;
+  }
+
+  if (ap) {
+    nvs_set_blob(handle, WIFI_NVS_AP_KEY, ap, sizeof(wifi_cached_ap_t));
+  } else {
+    nvs_erase_key(handle, WIFI_NVS_AP_KEY);
+  }
+  nvs_commit(handle);
+  nvs_close(handle);
+}
+
+#ifdef WIFI_STATIC_IP
+static void pipecat_wifi_set_static_ip(esp_netif_t *netif) {
+  esp_netif_ip_info_t ip_info;
+  memset(&ip_info, 0, sizeof(ip_info));
+  ip_info.ip.addr = esp_ip4addr_aton(WIFI_STATIC_IP);
+  ip_info.netmask.addr = esp_ip4addr_aton(WIFI_STATIC_NETMASK);
+  ip_info.gw.addr = esp_ip4addr_aton(WIFI_STATIC_GATEWAY);
+
+  esp_netif_dns_info_t dns_info;
+  memset(&dns_info, 0, sizeof(dns_info));
+  dns_info.ip.type = ESP_IPADDR_TYPE_V4;
+  dns_info.ip.u_addr.ip4.addr = esp_ip4addr_aton(WIFI_STATIC_DNS);
+
+  ESP_ERROR_CHECK(esp_netif_dhcpc_stop(netif));
+  ESP_ERROR_CHECK(esp_netif_set_ip_info(netif, &ip_info));
+  ESP_ERROR_CHECK(esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns_info));
+  ESP_LOGI(LOG_TAG, "Using static IP %s", WIFI_STATIC_IP);
+}
+#endif
+
+// Starts an association with `wifi_config` and waits until the station is
+// associated or gives up. Returns false on failure.
+static bool pipecat_wifi_associate(wifi_config_t *wifi_config, bool directed,
+                                   TickType_t timeout) {
+  wifi_directed = directed;
+  s_retry_num = 0;
+  xEventGroupClearBits(wifi_event_group, WIFI_FAIL_BIT);
+
+  ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, wifi_config));
+  ESP_ERROR_CHECK(esp_wifi_connect());
+
+  EventBits_t bits = xEventGroupWaitBits(
+      wifi_event_group, WIFI_ASSOCIATED_BIT | WIFI_FAIL_BIT, pdFALSE, pdFALSE,
+      timeout);
+  if (bits & WIFI_ASSOCIATED_BIT) {
+    return true;
+  }
+
+  if (!(bits & WIFI_FAIL_BIT)) {
+    // Timed out, stop the attempt before the configuration changes.
+    esp_wifi_disconnect();
+    xEventGroupWaitBits(wifi_event_group, WIFI_FAIL_BIT, pdFALSE, pdFALSE,
+                        pdMS_TO_TICKS(WIFI_DISCONNECT_TIMEOUT_MS));
+  }
+  return false;
+}
+
+void pipecat_init_wifi() {
+  wifi_event_group = xEventGroupCreate();
+
+  ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
+                                             &pipecat_event_handler, NULL));
+  ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                             &pipecat_event_handler, NULL));
+
+  esp_netif_t *sta_netif = esp_netif_create_default_wifi_sta();
+  assert(sta_netif);
+
+#ifdef WIFI_STATIC_IP
+  pipecat_wifi_set_static_ip(sta_netif);
+#endif
+
+  wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+  ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+  ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+  // Modem sleep delays downlink audio by up to a beacon interval.
+  ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_NONE));
+  ESP_ERROR_CHECK(esp_wifi_start());
+
+  ESP_LOGI(LOG_TAG, "Connecting to WiFi SSID: %s", WIFI_SSID);
+  wifi_config_t wifi_config;
+  memset(&wifi_config, 0, sizeof(wifi_config));
+  strncpy((char *)wifi_config.sta.ssid, (char *)WIFI_SSID,
+          sizeof(wifi_config.sta.ssid));
+  strncpy((char *)wifi_config.sta.password, (char *)WIFI_PASSWORD,
+          sizeof(wifi_config.sta.password));
+
+  wifi_cached_ap_t cached_ap;
+  bool associated = false;
+  if (pipecat_wifi_load_ap(&cached_ap)) {
+    ESP_LOGI(LOG_TAG, "Associating with cached AP " MACSTR " on channel %d",
+             MAC2STR(cached_ap.bssid), cached_ap.channel);
+    wifi_config.sta.bssid_set = true;
+    memcpy(wifi_config.sta.bssid, cached_ap.bssid, sizeof(cached_ap.bssid));
+    wifi_config.sta.channel = cached_ap.channel;
+
+    associated = pipecat_wifi_associate(
+        &wifi_config, true, pdMS_TO_TICKS(WIFI_DIRECTED_TIMEOUT_MS));
+    if (!associated) {
+      ESP_LOGW(LOG_TAG, "Cached AP unavailable, falling back to a full scan");
+      pipecat_wifi_store_ap(NULL);
+      wifi_config.sta.bssid_set = false;
+      memset(wifi_config.sta.bssid, 0, sizeof(wifi_config.sta.bssid));
+      wifi_config.sta.channel = 0;
+    }
+  }
+
+  if (!associated) {
+    associated = pipecat_wifi_associate(&wifi_config, false, portMAX_DELAY);
+  }
+
+  // block until we get an IP address
+  EventBits_t bits =
+      associated ? xEventGroupWaitBits(wifi_event_group,
+                                       WIFI_GOT_IP_BIT | WIFI_FAIL_BIT,
+                                       pdFALSE, pdFALSE, portMAX_DELAY)
+                 : WIFI_FAIL_BIT;
+  if (!(bits & WIFI_GOT_IP_BIT)) {
+    ESP_LOGE(LOG_TAG, "Unable to connect to WiFi SSID: %s", WIFI_SSID);
+    esp_restart();
+  }
+
+  wifi_ap_record_t ap_info;
+  if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+    return;
+  }
+  ESP_LOGI(LOG_TAG, "Connected to AP: %s, RSSI: %d, Channel: %d",
+           ap_info.ssid, ap_info.rssi, ap_info.primary);
+
+  if (!wifi_config.sta.bssid_set || ap_info.primary != cached_ap.channel ||
+      memcmp(ap_info.bssid, cached_ap.bssid, sizeof(cached_ap.bssid)) != 0) {
+    memcpy(cached_ap.bssid, ap_info.bssid, sizeof(cached_ap.bssid));
+    cached_ap.channel = ap_info.primary;
+    pipecat_wifi_store_ap(&cached_ap);
+  }
+}
@@ -0,0 +1,185 @@
+#include <driver/i2s_std.h>
+#include <esp_codec_dev.h>
+#include <esp_codec_dev_defaults.h>
+
+#include "driver/i2c_master.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "main.h"
+
+// The I2S DMA holds this many frames ahead of the speaker
+#define SPEAKER_DMA_BUFFERS 6
+#define SPEAKER_DMA_FRAMES 240
+
+static M5GFX display;
+static i2c_master_bus_handle_t i2c_bus;
+static esp_codec_dev_handle_t audio_dev;
+static i2s_chan_handle_t speaker_handle = nullptr;
+
+static void configure_pi4ioe(void) {
+  i2c_master_dev_handle_t i2c_device;
+  i2c_device_config_t i2c_device_cfg = {
+      .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+      .device_address = 0x43,  // PI4IOE Address
+      .scl_speed_hz = 400 * 1000,
+      .scl_wait_us = 0,
+      .flags =
+          {
+              .disable_ack_check = 0,
+          },
+  };
+  ESP_ERROR_CHECK(
+      i2c_master_bus_add_device(i2c_bus, &i2c_device_cfg, &i2c_device));
+
+  auto writeRegister = [=](uint8_t reg, uint8_t value) {
+    uint8_t buffer[2] = {reg, value};
+    ESP_ERROR_CHECK(i2c_master_transmit(i2c_device, buffer, 2, 100));
+  };
+
+  writeRegister(0x07, 0x00);  // Set to high-impedance
+  writeRegister(0x0D, 0xFF);  // Enable pull-up
+  writeRegister(0x03, 0x6E);  // Set input=0, output=1
+  writeRegister(0x05, 0xFF);  // Unmute speaker
+  i2c_master_bus_rm_device(i2c_device);
+}
+
+static void configure_es8311(void) {
+  i2s_chan_config_t chan_cfg = {
+      .id = I2S_NUM_0,
+      .role = I2S_ROLE_MASTER,
+      .dma_desc_num = SPEAKER_DMA_BUFFERS,
+      .dma_frame_num = SPEAKER_DMA_FRAMES,
+      .auto_clear_after_cb = true,
+      .auto_clear_before_cb = false,
+      .intr_priority = 0,
+  };
+
+  i2s_chan_handle_t tx_handle = nullptr, rx_handle = nullptr;
+  ESP_ERROR_CHECK(i2s_new_channel(&chan_cfg, &tx_handle, &rx_handle));
+
+  i2s_std_config_t std_cfg = {
+      .clk_cfg =
+          {
+              .sample_rate_hz = board_traits::sample_rate,
+              .clk_src = I2S_CLK_SRC_DEFAULT,
+              .ext_clk_freq_hz = 0,
+              .mclk_multiple = I2S_MCLK_MULTIPLE_256,
+          },
+      .slot_cfg = {.data_bit_width = I2S_DATA_BIT_WIDTH_16BIT,
+                   .slot_bit_width = I2S_SLOT_BIT_WIDTH_AUTO,
+                   .slot_mode = I2S_SLOT_MODE_STEREO,
+                   .slot_mask = I2S_STD_SLOT_BOTH,
+                   .ws_width = I2S_DATA_BIT_WIDTH_16BIT,
+                   .ws_pol = false,
+                   .bit_shift = true,
+                   .left_align = true,
+                   .big_endian = false,
+                   .bit_order_lsb = false},
+      .gpio_cfg = {.mclk = GPIO_NUM_NC,
+                   .bclk = GPIO_NUM_8,
+                   .ws = GPIO_NUM_6,
+                   .dout = GPIO_NUM_5,
+                   .din = GPIO_NUM_7,
+                   .invert_flags = {.mclk_inv = false,
+                                    .bclk_inv = false,
+                                    .ws_inv = false}}};
+
+  ESP_ERROR_CHECK(i2s_channel_init_std_mode(tx_handle, &std_cfg));
+  ESP_ERROR_CHECK(i2s_channel_init_std_mode(rx_handle, &std_cfg));
+  speaker_handle = tx_handle;
+
+  audio_codec_i2s_cfg_t i2s_cfg = {
+      .port = I2S_NUM_0,
+      .rx_handle = rx_handle,
+      .tx_handle = tx_handle,
+  };
+  audio_codec_i2c_cfg_t i2c_cfg = {
+      .port = I2C_NUM_1,
+      .addr = ES8311_CODEC_DEFAULT_ADDR,
+      .bus_handle = i2c_bus,
+  };
+  es8311_codec_cfg_t es8311_cfg = {
+      .ctrl_if = audio_codec_new_i2c_ctrl(&i2c_cfg),
+      .gpio_if = audio_codec_new_gpio(),
+      .codec_mode = ESP_CODEC_DEV_WORK_MODE_BOTH,
+      .pa_pin = GPIO_NUM_NC,
+      .use_mclk = false,
+      .hw_gain = {.pa_voltage = 5.0, .codec_dac_voltage = 3.3}};
+
+  esp_codec_dev_cfg_t dev_cfg = {
+      .dev_type = ESP_CODEC_DEV_TYPE_IN_OUT,
+      .codec_if = es8311_codec_new(&es8311_cfg),
+      .data_if = audio_codec_new_i2s_data(&i2s_cfg),
+  };
+  audio_dev = esp_codec_dev_new(&dev_cfg);
+
+  esp_codec_dev_sample_info_t fs = {
+      .bits_per_sample = 16,
+      .channel = 1,
+      .channel_mask = 0,
+      .sample_rate = board_traits::sample_rate,
+      .mclk_multiple = 0,
+  };
+  ESP_ERROR_CHECK(esp_codec_dev_open(audio_dev, &fs));
+  ESP_ERROR_CHECK(esp_codec_dev_set_in_gain(audio_dev, 30.0));
+  ESP_ERROR_CHECK(esp_codec_dev_set_out_vol(audio_dev, 100));
+}
+
+void pipecat_board_init() {}
+
+M5GFX *pipecat_board_init_display() {
+  return display.init() ? &display : NULL;
+}
+
+void pipecat_board_init_audio() {
+  i2c_master_bus_config_t i2c_bus_cfg = {
+      .i2c_port = I2C_NUM_1,
+      .sda_io_num = GPIO_NUM_38,
+      .scl_io_num = GPIO_NUM_39,
+      .clk_source = I2C_CLK_SRC_DEFAULT,
+      .glitch_ignore_cnt = 7,
+      .intr_priority = 0,
+      .trans_queue_depth = 0,
+      .flags =
+          {
+              .enable_internal_pullup = 1,
+          },
+  };
+  ESP_ERROR_CHECK(i2c_new_master_bus(&i2c_bus_cfg, &i2c_bus));
+  configure_pi4ioe();
+  configure_es8311();
+}
+
+bool pipecat_board_read_audio(int16_t *pcm, size_t samples) {
+  return ESP_ERROR_CHECK_WITHOUT_ABORT(esp_codec_dev_read(
+             audio_dev, pcm, samples * sizeof(int16_t))) == ESP_OK;
+}
+
+void pipecat_board_write_audio(int16_t *pcm, size_t samples) {
+  ESP_ERROR_CHECK_WITHOUT_ABORT(
+      esp_codec_dev_write(audio_dev, pcm, samples * sizeof(int16_t)));
+}
+
+// Replaces the audio queued in the TX DMA buffers with `pcm` and silence
+// after it. The microphone shares the channel's clock and misses the few
+// samples this takes. Called from the task that writes the speaker.
+void pipecat_board_flush_audio(const int16_t *pcm, size_t samples) {
+  static const int16_t silence[SPEAKER_DMA_FRAMES] = {};
+  if (i2s_channel_disable(speaker_handle) != ESP_OK) {
+    return;
+  }
+  size_t loaded = 0;
+  if (samples > 0) {
+    i2s_channel_preload_data(speaker_handle, pcm, samples * sizeof(int16_t),
+                             &loaded);
+  }
+  for (int i = 0; i <= SPEAKER_DMA_BUFFERS; i++) {
+    loaded = 0;
+    i2s_channel_preload_data(speaker_handle, silence, sizeof(silence),
+                             &loaded);
+    if (loaded < sizeof(silence)) {
+      break;
+    }
+  }
+  ESP_ERROR_CHECK_WITHOUT_ABORT(i2s_channel_enable(speaker_handle));
+}
@@ -0,0 +1,54 @@
+#include "esp_log.h"
+#include "main.h"
+
+static bool speaker_enabled = false;
+
+void pipecat_board_init() {
+  auto cfg = M5.config();
+  M5.begin(cfg);
+}
+
+M5GFX *pipecat_board_init_display() { return &M5.Display; }
+
+void pipecat_board_init_audio() {
+  M5.Speaker.setVolume(200);
+  // Start with microphone active by default
+  M5.Mic.begin();
+}
+
+bool pipecat_board_read_audio(int16_t *pcm, size_t samples) {
+  return M5.Mic.record(pcm, samples, board_traits::sample_rate);
+}
+
+// Only plays while pipecat_board_set_playing has the speaker enabled.
+void pipecat_board_write_audio(int16_t *pcm, size_t samples) {
+  if (!speaker_enabled) {
+    return;
+  }
+  M5.Speaker.playRaw(pcm, samples, board_traits::sample_rate);
+}
+
+// Drops what M5.Speaker still has queued and plays `pcm` instead.
+void pipecat_board_flush_audio(const int16_t *pcm, size_t samples) {
+  M5.Speaker.stop();
+  if (speaker_enabled && samples > 0) {
+    M5.Speaker.playRaw(pcm, samples, board_traits::sample_rate);
+  }
+}
+
+// The microphone and the speaker share the I2S port, switch between them.
+// Takes ~10 ms plus the driver restarts, the pre-roll in media.cpp keeps
+// the onset that arrives meanwhile.
+void pipecat_board_set_playing(bool playing) {
+  if (playing) {
+    speaker_enabled = true;
+    M5.Mic.end();
+    vTaskDelay(pdMS_TO_TICKS(10));  // Brief delay to ensure clean switch
+    M5.Speaker.begin();
+  } else {
+    speaker_enabled = false;
+    M5.Speaker.end();
+    vTaskDelay(pdMS_TO_TICKS(10));  // Brief delay to ensure clean switch
+    M5.Mic.begin();
+  }
+}
@@ -0,0 +1,63 @@
+#include <M5Unified.h>
+#include <esp_heap_caps.h>
+
+// Describes the M5Stack CoreS3 to the shared pipeline in ../../common.
+struct board_traits {
+  static constexpr int sample_rate = 16000;
+  // M5Unified opens the microphone and the speaker as two I2S drivers on
+  // the same port (I2S_NUM_1, BCK 34 and WS 33), so only one of them can be
+  // running. Every turn change ends one and begins the other, see
+  // pipecat_board_set_playing.
+  static constexpr bool full_duplex = false;
+  // Frames buffered ahead of the speaker, 0 writes them as they are decoded.
+  // M5.Speaker plays straight from the caller's buffer and keeps its own
+  // queue, so frames can't be handed to it from the play queue and there's
+  // no drift compensation.
+  static constexpr int play_buffer_frames = 0;
+  // Decoded frames that peak above playback_activity_level are the bot
+  // talking. Playback starts playback_onset_frames frames after the first of
+  // them, counting it. Every start switches the I2S bus over to the speaker, so
+  // it waits for ~60 ms of clear activity instead of the first click.
+  static constexpr int playback_activity_level = 100;
+  static constexpr int playback_onset_frames = 3;
+  // Decoded frames quieter than this RMS are muted, 0 plays every frame.
+  static constexpr int playback_gate_rms = 40;
+  // The microphone is off while the bot plays, interruptions are left to the
+  // server.
+  static constexpr int barge_in_rms = 0;
+  static constexpr int barge_in_frames = 0;
+  // Where the PCM and Opus buffers are allocated, and the queues of audio
+  // waiting to be decoded or played.
+  static constexpr uint32_t buffer_caps = MALLOC_CAP_DMA;
+  static constexpr uint32_t bulk_buffer_caps = MALLOC_CAP_SPIRAM;
+
+  static constexpr int send_task_stack_size = 25000;
+  static constexpr uint32_t send_task_stack_caps = MALLOC_CAP_DMA;
+  static constexpr int send_task_priority = configMAX_PRIORITIES - 2;
+
+  static constexpr int opus_bitrate = 24000;
+  static constexpr bool opus_vbr = false;
+  static constexpr bool opus_dtx = true;
+
+  // Capture processing between the microphone and the encoder. M5Unified
+  // already filters noise from the microphone.
+  static constexpr uint32_t capture_dsp =
+      PIPECAT_DSP_HIGHPASS | PIPECAT_DSP_AGC;
+
+  // The display and the codec are configured over the same I2C controller
+  // and can't come up concurrently.
+  static constexpr bool display_shares_codec_bus = true;
+  static constexpr float screen_text_size = 1.5;
+};
+
+// Board
+extern void pipecat_board_init();
+extern M5GFX *pipecat_board_init_display();
+extern void pipecat_board_init_audio();
+extern bool pipecat_board_read_audio(int16_t *pcm, size_t samples);
+extern void pipecat_board_write_audio(int16_t *pcm, size_t samples);
+// Replaces the audio the speaker driver still holds with `pcm`, the last
+// frame faded out, see pipecat_audio_flush.
+extern void pipecat_board_flush_audio(const int16_t *pcm, size_t samples);
+// Only half-duplex boards switch between the microphone and the speaker.
+extern void pipecat_board_set_playing(bool playing);
@@ -1,56 +0,0 @@
-#include "main.h"
-
-#include <esp_event.h>
-#include <esp_log.h>
-#include <peer.h>
-
-#ifndef LINUX_BUILD
-#include "nvs_flash.h"
-
-extern "C" void app_main(void) {
-  esp_err_t ret = nvs_flash_init();
-  if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
-      ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-    ESP_ERROR_CHECK(nvs_flash_erase());
-    ret = nvs_flash_init();
-  }
-  ESP_ERROR_CHECK(ret);
-
-  auto cfg = M5.config();
-  M5.begin(cfg);
-
-  M5.Display.setBrightness(70);
-  M5.Display.setTextSize(1.5);
-  M5.Display.fillScreen(BLACK);
-  M5.Display.println("Pipecat ESP32 client initialized\n");
-
-  ESP_ERROR_CHECK(esp_event_loop_create_default());
-  peer_init();
-  
-  // Initialize audio components in correct order
-  pipecat_init_audio_capture();
-  pipecat_init_audio_decoder();
-  // Note: pipecat_init_audio_encoder() is called later in the audio task
-  
-  // Use optimized WiFi and WebRTC initialization
-  pipecat_init_wifi();        // This is your optimized WiFi code
-  pipecat_init_webrtc();      // This is your optimized WebRTC code
-
-  while (1) {
-    pipecat_webrtc_loop();
-    vTaskDelay(pdMS_TO_TICKS(TICK_INTERVAL));
-  }
-}
-#else
-int main(void) {
-  ESP_ERROR_CHECK(esp_event_loop_create_default());
-  peer_init();
-  pipecat_init_audio_encoder();
-  pipecat_webrtc();
-
-  while (1) {
-    pipecat_webrtc_loop();
-    vTaskDelay(pdMS_TO_TICKS(TICK_INTERVAL));
-  }
-}
-#endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include <bsp/esp-bsp.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "main.h"
+
+// Audio the BSP's I2S DMA holds ahead of the speaker, 6 buffers of 240
+// frames. The BSP doesn't hand out its I2S channels to drop it, a flush mutes
+// the codec until it has played out instead.
+#define SPEAKER_DMA_US (6 * 240 * 1000000LL / board_traits::sample_rate)
+
+static esp_codec_dev_handle_t mic_codec_dev = NULL;
+static esp_codec_dev_handle_t spk_codec_dev = NULL;
+static int64_t speaker_muted_until = 0;
+
+#ifdef MIC_BEAMFORMING
+// The ES7210 delivers four TDM slots: the speaker reference, the first
+// microphone, an unused input and the second microphone. All four are
+// enabled, esp_codec_dev packs only the slots in the mask, so the frames
+// keep a stride of CAPTURE_CHANNELS with the slots at their own index.
+#define CAPTURE_CHANNELS 4
+#define CAPTURE_UNUSED_SLOT 2
+#define CAPTURE_REFERENCE_SLOT 0
+#define CAPTURE_MIC_A_SLOT 1
+#define CAPTURE_MIC_B_SLOT 3
+#define CAPTURE_FRAME_SAMPLES (board_traits::sample_rate / 50)
+
+static int16_t *capture_buffer = NULL;
+#endif
+
+void pipecat_board_init() {
+  // The touch panel and the codec share the BSP I2C bus, which must exist
+  // before their tasks start.
+  ESP_ERROR_CHECK(bsp_i2c_init());
+}
+
+void pipecat_board_init_audio() {
+  mic_codec_dev = bsp_audio_codec_microphone_init();
+  spk_codec_dev = bsp_audio_codec_speaker_init();
+
+  esp_codec_dev_set_in_gain(mic_codec_dev, 42.0);
+  esp_codec_dev_set_out_vol(spk_codec_dev, 255);
+
+  esp_codec_dev_sample_info_t fs = {
+      .bits_per_sample = 16,
+      .channel = 1,
+      .sample_rate = board_traits::sample_rate,
+  };
+  esp_codec_dev_open(spk_codec_dev, &fs);
+
+#ifdef MIC_BEAMFORMING
+  esp_codec_dev_sample_info_t capture_fs = {
+      .bits_per_sample = 16,
+      .channel = CAPTURE_CHANNELS,
+      .channel_mask = ESP_CODEC_DEV_MAKE_CHANNEL_MASK(CAPTURE_REFERENCE_SLOT) |
+                      ESP_CODEC_DEV_MAKE_CHANNEL_MASK(CAPTURE_MIC_A_SLOT) |
+                      ESP_CODEC_DEV_MAKE_CHANNEL_MASK(CAPTURE_UNUSED_SLOT) |
+                      ESP_CODEC_DEV_MAKE_CHANNEL_MASK(CAPTURE_MIC_B_SLOT),
+      .sample_rate = board_traits::sample_rate,
+  };
+  esp_codec_dev_open(mic_codec_dev, &capture_fs);
+  capture_buffer = (int16_t *)heap_caps_malloc(
+      CAPTURE_FRAME_SAMPLES * CAPTURE_CHANNELS * sizeof(int16_t),
+      board_traits::buffer_caps);
+#else
+  esp_codec_dev_open(mic_codec_dev, &fs);
+#endif
+}
+
+bool pipecat_board_read_audio(int16_t *pcm, size_t samples) {
+#ifdef MIC_BEAMFORMING
+  if (samples > CAPTURE_FRAME_SAMPLES) {
+    samples = CAPTURE_FRAME_SAMPLES;
+  }
+  if (esp_codec_dev_read(mic_codec_dev, capture_buffer,
+                         samples * CAPTURE_CHANNELS * sizeof(int16_t)) !=
+      ESP_OK) {
+    printf("esp_codec_dev_read failed");
+    return false;
+  }
+  // The reference slot is read along but unused, the pipeline mutes the
+  // microphones while the bot speaks.
+  pipecat_beamform(capture_buffer, samples, CAPTURE_CHANNELS,
+                   CAPTURE_MIC_A_SLOT, CAPTURE_MIC_B_SLOT, pcm);
+  return true;
+#else
+  if (esp_codec_dev_read(mic_codec_dev, pcm, samples * sizeof(int16_t)) !=
+      ESP_OK) {
+    printf("esp_codec_dev_read failed");
+    return false;
+  }
+  return true;
+#endif
+}
+
+void pipecat_board_write_audio(int16_t *pcm, size_t samples) {
+  if (speaker_muted_until != 0 && esp_timer_get_time() >= speaker_muted_until) {
+    speaker_muted_until = 0;
+    esp_codec_dev_set_out_mute(spk_codec_dev, false);
+  }
+
+  esp_err_t ret;
+  if ((ret = esp_codec_dev_write(spk_codec_dev, pcm,
+                                 samples * sizeof(int16_t))) != ESP_OK) {
+    ESP_LOGE(LOG_TAG, "esp_codec_dev_write failed: %s", esp_err_to_name(ret));
+  }
+}
+
+// The faded out frame would only play muted, it is dropped. Called from the
+// task that writes the speaker.
+void pipecat_board_flush_audio(const int16_t *pcm, size_t samples) {
+  esp_codec_dev_set_out_mute(spk_codec_dev, true);
+  speaker_muted_until = esp_timer_get_time() + SPEAKER_DMA_US;
+}
@@ -0,0 +1,60 @@
+#include <bsp/esp-bsp.h>
+#include <esp_heap_caps.h>
+
+// Describes the ESP32-S3-BOX-3 to the shared pipeline in ../../common.
+struct board_traits {
+  static constexpr int sample_rate = 16000;
+  // The codec keeps capturing while it plays.
+  static constexpr bool full_duplex = true;
+  // Frames buffered ahead of the speaker, 0 writes them as they are decoded.
+  // A short queue absorbs the drift between the sender's clock and the
+  // codec's, see drift.cpp.
+  static constexpr int play_buffer_frames = 3;
+  // Decoded frames that peak above playback_activity_level are the bot
+  // talking. Playback starts playback_onset_frames frames after the first of
+  // them, counting it.
+  static constexpr int playback_activity_level = 1;
+  static constexpr int playback_onset_frames = 1;
+  // Decoded frames quieter than this RMS are muted, 0 plays every frame.
+  static constexpr int playback_gate_rms = 0;
+  // While the bot plays, barge_in_frames microphone frames in a row above
+  // barge_in_rms are the user talking over it and flush playback on the
+  // device. The level sits above the bot's own voice picked up at full volume.
+  static constexpr int barge_in_rms = 3000;
+  static constexpr int barge_in_frames = 5;
+  // Where the PCM and Opus buffers are allocated, and the queues of audio
+  // waiting to be decoded or played.
+  static constexpr uint32_t buffer_caps = MALLOC_CAP_DEFAULT;
+  static constexpr uint32_t bulk_buffer_caps = MALLOC_CAP_SPIRAM;
+
+  // Opus runs on these stacks, keep them out of the PSRAM cache.
+  // MEMORY_PROFILE reports how much of them is used, shrink them only from
+  // its numbers.
+  static constexpr int send_task_stack_size = 30000;
+  static constexpr uint32_t send_task_stack_caps = MALLOC_CAP_INTERNAL;
+  static constexpr int send_task_priority = 7;
+
+  static constexpr int opus_bitrate = 30000;
+  static constexpr bool opus_vbr = true;
+  static constexpr bool opus_dtx = false;
+
+  // Capture processing between the microphone and the encoder
+  static constexpr uint32_t capture_dsp = PIPECAT_DSP_HIGHPASS |
+                                          PIPECAT_DSP_NOISE_SUPPRESSION |
+                                          PIPECAT_DSP_AGC;
+
+  // The display and the codec are configured over the same I2C controller
+  // and can't come up concurrently.
+  static constexpr bool display_shares_codec_bus = false;
+};
+
+// Board
+extern void pipecat_board_init();
+extern void pipecat_board_init_audio();
+extern bool pipecat_board_read_audio(int16_t *pcm, size_t samples);
+extern void pipecat_board_write_audio(int16_t *pcm, size_t samples);
+// Replaces the audio the speaker driver still holds with `pcm`, the last
+// frame faded out, see pipecat_audio_flush.
+extern void pipecat_board_flush_audio(const int16_t *pcm, size_t samples);
+// Only half-duplex boards switch between the microphone and the speaker.
+extern void pipecat_board_set_playing(bool playing);
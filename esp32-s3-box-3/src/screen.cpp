@@ -1,17 +1,47 @@
 #include <bsp/esp-bsp.h>
+#include <esp_timer.h>
 #include <lvgl.h>
 #include <string.h>
 
 #include "main.h"
 
 #define SCREEN_TICK_INTERVAL 50
+// LVGL pauses its refresh timer when nothing is invalidated, so the port task
+// only needs to wake up for our own notifications.
+#define SCREEN_MAX_SLEEP_MS 10000
 #define MAX_LOG_LINES 10
+#define MAX_LOG_LINE_LENGTH 512
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+// Each line owns two fixed text buffers, so appending never allocates. Words
+// are appended to `text` under `log_mutex`. `shown` is what its label renders
+// from (lv_label_set_text_static), only copied from `text` with the display
+// lock held, so LVGL never draws a line while it changes. Bytes past `length`
+// are always zero, which keeps both terminated.
+typedef struct {
+  char text[MAX_LOG_LINE_LENGTH];
+  char shown[MAX_LOG_LINE_LENGTH];
+  size_t length;
+  lv_style_t *style;
+  lv_obj_t *label;
+  lv_style_t *label_style;
+  bool recycled;
+  bool dirty;
+} log_line_t;
 
 static lv_obj_t *screen = NULL;
 static lv_obj_t *log_container = NULL;
-static lv_obj_t *log_label = NULL;
-static lv_obj_t *log_labels[MAX_LOG_LINES];
+static TaskHandle_t screen_task_handle = NULL;
+static int64_t render_start_us = 0;
+
+static log_line_t log_lines[MAX_LOG_LINES];
+static int log_newest = -1;
 static int log_line_count = 0;
+static bool log_dirty = false;
+static SemaphoreHandle_t log_mutex = NULL;
 
 static lv_style_t STYLE_BLUE;
 static lv_style_t STYLE_GREEN;
@@ -49,47 +79,179 @@ static lv_obj_t *create_label(lv_obj_t *container, lv_style_t *style) {
   lv_obj_add_style(label, style, 0);
   lv_obj_set_width(label, LV_PCT(100));
   lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
-  lv_label_set_text(label, "");
   return label;
 }
 
-static void create_current_label(lv_obj_t *container, lv_style_t *style) {
-  // Delete oldest labels.
-  if (log_line_count >= MAX_LOG_LINES) {
-    lv_obj_del(log_labels[0]);
+// Must be called with `log_mutex` held.
+static log_line_t *new_log_line(lv_style_t *style) {
+  log_newest = (log_newest + 1) % MAX_LOG_LINES;
+  if (log_line_count < MAX_LOG_LINES) {
+    log_line_count++;
+  }
 
-    // Shift remaining labels
-    for (int i = 1; i < MAX_LOG_LINES; ++i) {
-      log_labels[i - 1] = log_labels[i];
+  // Once the ring is full this reuses the oldest line (and its label).
+  log_line_t *line = &log_lines[log_newest];
+  memset(line->text, 0, sizeof(line->text));
+  line->length = 0;
+  line->style = style;
+  line->recycled = true;
+  log_dirty = true;
+  return line;
+}
+
+// Must be called with `log_mutex` held.
+static void append_log_text(const char *text) {
+  if (log_line_count == 0) {
+    new_log_line(&STYLE_DEFAULT);
+  }
+
+  log_line_t *line = &log_lines[log_newest];
+  size_t len = strlen(text);
+  while (len > 0) {
+    size_t space = MAX_LOG_LINE_LENGTH - 1 - line->length;
+    size_t copy_len = MIN(len, space);
+    // Split between UTF-8 codepoints, not inside one.
+    while (copy_len > 0 && copy_len < len &&
+           ((uint8_t)text[copy_len] & 0xC0) == 0x80) {
+      copy_len--;
+    }
+    if (copy_len == 0) {
+      if (line->length > 0) {
+        // Continue long transcripts on a new line with the same style.
+        line = new_log_line(line->style);
+        continue;
+      }
+      // Not UTF-8, split where the line is full.
+      copy_len = MIN(len, space);
     }
-    log_line_count--;
+
+    memcpy(line->text + line->length, text, copy_len);
+    line->length += copy_len;
+    line->dirty = true;
+    text += copy_len;
+    len -= copy_len;
   }
+  log_dirty = true;
+}
 
-  log_label = create_label(container, style);
-  log_labels[log_line_count++] = log_label;
+// Must be called with the display lock and `log_mutex` held.
+static void sync_log_labels() {
+  lv_obj_t *newest_label = NULL;
+  int oldest =
+      (log_newest - log_line_count + 1 + MAX_LOG_LINES) % MAX_LOG_LINES;
+
+  for (int i = 0; i < log_line_count; ++i) {
+    log_line_t *line = &log_lines[(oldest + i) % MAX_LOG_LINES];
+
+    if (line->recycled) {
+      if (line->label == NULL) {
+        line->label = create_label(log_container, line->style);
+      } else {
+        if (line->label_style != line->style) {
+          lv_obj_replace_style(line->label, line->label_style, line->style, 0);
+        }
+        // Recycled labels move to the bottom of the log, in ring order.
+        lv_obj_move_foreground(line->label);
+      }
+      line->label_style = line->style;
+    }
+
+    if (line->recycled || line->dirty) {
+      memcpy(line->shown, line->text, sizeof(line->shown));
+      lv_label_set_text_static(line->label, line->shown);
+      line->recycled = false;
+      line->dirty = false;
+    }
+    newest_label = line->label;
+  }
+
+  if (newest_label) {
+    lv_obj_scroll_to_view_recursive(newest_label, LV_ANIM_OFF);
+  }
+  log_dirty = false;
 }
 
+static void invalidate_screen() {
+  if (screen_task_handle) {
+    xTaskNotifyGive(screen_task_handle);
+  }
+}
+
+static void on_render_event(lv_event_t *e) {
+  if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+    render_start_us = esp_timer_get_time();
+  } else if (render_start_us != 0) {
+    ESP_LOGD(LOG_TAG, "Screen frame rendered in %lld us",
+             esp_timer_get_time() - render_start_us);
+    render_start_us = 0;
+  }
+}
+
+// Sleeps until a log API invalidates the screen, then coalesces every update
+// made since into a single LVGL update. At most one update is applied per
+// SCREEN_TICK_INTERVAL; rendering itself happens in the LVGL port task.
 static void screen_task(void *pvParameter) {
   while (1) {
-    lv_timer_handler();
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    if (log_dirty && bsp_display_lock(0)) {
+      xSemaphoreTake(log_mutex, portMAX_DELAY);
+      sync_log_labels();
+      xSemaphoreGive(log_mutex);
+      bsp_display_unlock();
+      lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+    }
+
     vTaskDelay(pdMS_TO_TICKS(SCREEN_TICK_INTERVAL));
   }
 }
 
 void pipecat_init_screen() {
-  bsp_display_start();
+  log_mutex = xSemaphoreCreateMutex();
+
+  bsp_display_cfg_t cfg = {
+      .lvgl_port_cfg = ESP_LVGL_PORT_INIT_CONFIG(),
+      .buffer_size = BSP_LCD_DRAW_BUFF_SIZE,
+      .double_buffer = BSP_LCD_DRAW_BUFF_DOUBLE,
+      .flags =
+          {
+              .buff_dma = true,
+              .buff_spiram = false,
+          },
+  };
+  const pipecat_task_config_t *lvgl_task =
+      pipecat_task_config(PIPECAT_TASK_LVGL);
+  cfg.lvgl_port_cfg.task_priority = lvgl_task->priority;
+  cfg.lvgl_port_cfg.task_stack = lvgl_task->stack_size;
+  cfg.lvgl_port_cfg.task_affinity = lvgl_task->core;
+  cfg.lvgl_port_cfg.task_max_sleep_ms = SCREEN_MAX_SLEEP_MS;
+  lv_display_t *display = bsp_display_start_with_config(&cfg);
 
   bsp_display_backlight_on();
 
   bsp_display_lock(0);
 
+  // The log is not interactive, don't poll the touch panel.
+  lv_indev_t *touch = bsp_display_get_input_dev();
+  if (touch) {
+    lv_indev_set_mode(touch, LV_INDEV_MODE_EVENT);
+  }
+
+  lv_display_add_event_cb(display, on_render_event, LV_EVENT_RENDER_START,
+                          NULL);
+  lv_display_add_event_cb(display, on_render_event, LV_EVENT_REFR_READY,
+                          NULL);
+
   screen = lv_scr_act();
 
   init_styles();
 
   log_container = create_scrollable_log(screen);
 
-  xTaskCreatePinnedToCore(screen_task, "Screen Task", 8192, NULL, 1, NULL, 1);
+  bsp_display_unlock();
+
+  screen_task_handle =
+      pipecat_task_create(PIPECAT_TASK_SCREEN, screen_task, NULL);
 
   ESP_LOGI(LOG_TAG, "Display initialized");
 }
@@ -99,8 +261,11 @@ void pipecat_screen_system_log(const char *text) {
     return;
   }
 
-  create_current_label(log_container, &STYLE_DEFAULT);
-  pipecat_screen_log(text);
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  new_log_line(&STYLE_DEFAULT);
+  append_log_text(text);
+  xSemaphoreGive(log_mutex);
+  invalidate_screen();
 }
 
 void pipecat_screen_new_log() {
@@ -108,7 +273,10 @@ void pipecat_screen_new_log() {
     return;
   }
 
-  create_current_label(log_container, &STYLE_BLUE);
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  new_log_line(&STYLE_BLUE);
+  xSemaphoreGive(log_mutex);
+  invalidate_screen();
 }
 
 void pipecat_screen_log(const char *text) {
@@ -116,21 +284,8 @@ void pipecat_screen_log(const char *text) {
     return;
   }
 
-  const char *current_text = lv_label_get_text(log_label);
-  size_t current_len = strlen(current_text);
-  size_t new_len = current_len + strlen(text) + 1;
-
-  char *combined = (char *)malloc(new_len);
-  if (!combined) {
-    ESP_LOGW(LOG_TAG, "Failed to allocate memory for log text.");
-    return;
-  }
-
-  strcpy(combined, current_text);
-  strcat(combined, text);
-
-  lv_label_set_text(log_label, combined);
-  free(combined);
-
-  lv_obj_scroll_to_view_recursive(log_label, LV_ANIM_OFF);
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  append_log_text(text);
+  xSemaphoreGive(log_mutex);
+  invalidate_screen();
 }
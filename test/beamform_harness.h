@@ -0,0 +1,76 @@
+// Runs recorded multi-channel captures through pipecat_beamform and compares
+// the result with a single microphone, shared by beamform_test and the
+// beamform_wav tool.
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "main.h"
+#include "wav.h"
+
+// Slots of the S3-Box-3's ES7210 capture, see esp32-s3-box-3/src/board.cpp
+#define HARNESS_MIC_A_SLOT 1
+#define HARNESS_MIC_B_SLOT 3
+
+typedef struct {
+  double mic_snr_db;
+  double beamformed_snr_db;
+} beamform_result_t;
+
+// Estimates the SNR of a recording without a clean reference: the loudest
+// tenth of its 20 ms frames against the quietest tenth, which are speech and
+// the noise floor in a capture with pauses.
+static inline double estimate_snr_db(const std::vector<int16_t> &pcm,
+                                     int sample_rate) {
+  size_t frame = sample_rate / 50;
+  std::vector<double> energies;
+  for (size_t start = 0; start + frame <= pcm.size(); start += frame) {
+    double energy = 1e-3;
+    for (size_t i = start; i < start + frame; i++) {
+      energy += (double)pcm[i] * pcm[i];
+    }
+    energies.push_back(energy / frame);
+  }
+  if (energies.size() < 10) {
+    return 0;
+  }
+
+  std::sort(energies.begin(), energies.end());
+  size_t tenth = energies.size() / 10;
+  double quiet = 0, loud = 0;
+  for (size_t i = 0; i < tenth; i++) {
+    quiet += energies[i];
+    loud += energies[energies.size() - 1 - i];
+  }
+  return 10 * log10(loud / quiet);
+}
+
+// Beamforms `capture` frame by frame like the board read does and writes the
+// mono result to `out`.
+static inline beamform_result_t beamform_compare(const wav_t &capture,
+                                                 int mic_a, int mic_b,
+                                                 wav_t *out) {
+  size_t frames = capture.pcm.size() / capture.channels;
+  size_t frame = capture.sample_rate / 50;
+
+  std::vector<int16_t> mic(frames);
+  for (size_t n = 0; n < frames; n++) {
+    mic[n] = capture.pcm[n * capture.channels + mic_a];
+  }
+
+  out->sample_rate = capture.sample_rate;
+  out->channels = 1;
+  out->pcm.assign(frames, 0);
+  for (size_t start = 0; start < frames; start += frame) {
+    size_t samples = std::min(frame, frames - start);
+    pipecat_beamform(&capture.pcm[start * capture.channels], samples,
+                     capture.channels, mic_a, mic_b, &out->pcm[start]);
+  }
+
+  return {estimate_snr_db(mic, capture.sample_rate),
+          estimate_snr_db(out->pcm, capture.sample_rate)};
+}
@@ -0,0 +1,40 @@
+// Beamforms a recorded capture from the S3-Box-3 and reports how the SNR
+// compares with its first microphone alone:
+//
+//   beamform_wav capture.wav beamformed.wav [mic_a_slot mic_b_slot]
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "beamform_harness.h"
+
+int main(int argc, char **argv) {
+  if (argc != 3 && argc != 5) {
+    fprintf(stderr, "Usage: %s capture.wav out.wav [mic_a_slot mic_b_slot]\n",
+            argv[0]);
+    return 2;
+  }
+  int mic_a = argc == 5 ? atoi(argv[3]) : HARNESS_MIC_A_SLOT;
+  int mic_b = argc == 5 ? atoi(argv[4]) : HARNESS_MIC_B_SLOT;
+
+  wav_t capture;
+  if (!wav_read(argv[1], &capture)) {
+    fprintf(stderr, "Unable to read %s as 16-bit PCM WAV\n", argv[1]);
+    return 1;
+  }
+  if (mic_a >= capture.channels || mic_b >= capture.channels) {
+    fprintf(stderr, "%s has %d channels\n", argv[1], capture.channels);
+    return 1;
+  }
+
+  wav_t out;
+  beamform_result_t result = beamform_compare(capture, mic_a, mic_b, &out);
+  if (!wav_write(argv[2], &out)) {
+    fprintf(stderr, "Unable to write %s\n", argv[2]);
+    return 1;
+  }
+
+  printf("Microphone %d: %.1f dB SNR, beamformed: %.1f dB SNR (%+.1f dB)\n",
+         mic_a, result.mic_snr_db, result.beamformed_snr_db,
+         result.beamformed_snr_db - result.mic_snr_db);
+  return 0;
+}
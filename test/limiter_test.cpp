@@ -0,0 +1,111 @@
+// Runs speech-like tones and a clipped burst through the playback limiter and
+// checks that no output sample crosses the ceiling and that the level settles
+// on the loudness target.
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "main.h"
+
+#define SAMPLE_RATE 16000
+#define FRAME_SAMPLES (SAMPLE_RATE / 50)
+// Mirrors LIMITER_CEILING and LOUDNESS_TARGET_RMS in common/limiter.cpp
+#define CEILING 29204
+#define TARGET_RMS 5193
+// The level has to land within 1 dB of the target
+#define TARGET_TOLERANCE_DB 1.0
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+  printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+  if (!ok) {
+    failures++;
+  }
+}
+
+// A 220 Hz tone with the given peak, clipped to 16 bits.
+static std::vector<int16_t> tone(double amplitude, double seconds) {
+  std::vector<int16_t> pcm((size_t)(SAMPLE_RATE * seconds));
+  for (size_t n = 0; n < pcm.size(); n++) {
+    double x = amplitude * sin(2 * M_PI * 220 * n / SAMPLE_RATE);
+    pcm[n] = (int16_t)fmax(fmin(x, INT16_MAX), INT16_MIN);
+  }
+  return pcm;
+}
+
+static void append(std::vector<int16_t> *pcm, const std::vector<int16_t> &b) {
+  pcm->insert(pcm->end(), b.begin(), b.end());
+}
+
+// Processes the input in 20 ms frames, as media.cpp does.
+static std::vector<int16_t> process(std::vector<int16_t> pcm) {
+  pipecat_limiter_t *limiter =
+      pipecat_limiter_create(SAMPLE_RATE, FRAME_SAMPLES);
+  if (limiter == NULL) {
+    fprintf(stderr, "FAIL: unable to create the limiter\n");
+    exit(1);
+  }
+  for (size_t i = 0; i < pcm.size(); i += FRAME_SAMPLES) {
+    size_t samples = pcm.size() - i < FRAME_SAMPLES ? pcm.size() - i
+                                                    : FRAME_SAMPLES;
+    pipecat_limiter_process(limiter, &pcm[i], samples);
+  }
+  pipecat_limiter_destroy(limiter);
+  return pcm;
+}
+
+static int peak(const std::vector<int16_t> &pcm, size_t from) {
+  int peak = 0;
+  for (size_t i = from; i < pcm.size(); i++) {
+    peak = abs(pcm[i]) > peak ? abs(pcm[i]) : peak;
+  }
+  return peak;
+}
+
+static double rms(const std::vector<int16_t> &pcm, size_t from) {
+  double sum = 0;
+  for (size_t i = from; i < pcm.size(); i++) {
+    sum += (double)pcm[i] * pcm[i];
+  }
+  return sqrt(sum / (pcm.size() - from));
+}
+
+static void check_level(const char *name, double input_rms) {
+  // 10 s is several times the ~1.3 s the loudness gain takes to settle.
+  std::vector<int16_t> out = process(tone(input_rms * sqrt(2), 10));
+  double level = rms(out, out.size() - SAMPLE_RATE);
+  double error_db = 20 * log10(level / TARGET_RMS);
+  printf("%s: %.0f RMS in, %.0f RMS out (%+.2f dB), peak %d\n", name,
+         input_rms, level, error_db, peak(out, 0));
+  check(fabs(error_db) <= TARGET_TOLERANCE_DB, name);
+  check(peak(out, 0) <= CEILING, "peak below the ceiling");
+}
+
+int main() {
+  check_level("quiet sine is boosted to the target", 2000);
+  check_level("loud sine is cut to the target", 9000);
+
+  // A full scale sine, past the ceiling from the first sample.
+  std::vector<int16_t> out = process(tone(32767, 2));
+  printf("Full scale sine: peak %d\n", peak(out, 0));
+  check(peak(out, 0) <= CEILING, "full scale sine stays below the ceiling");
+
+  // A clipped burst at +12 dB right after the level settled, then back to
+  // speech: the look-ahead has to catch the first clipped sample.
+  std::vector<int16_t> burst = tone(TARGET_RMS * sqrt(2), 5);
+  append(&burst, tone(4 * 32767, 0.5));
+  append(&burst, tone(TARGET_RMS * sqrt(2), 2));
+  out = process(burst);
+  printf("Clipped burst: peak %d, %.0f RMS after recovery\n", peak(out, 0),
+         rms(out, out.size() - SAMPLE_RATE / 2));
+  check(peak(out, 0) <= CEILING, "clipped burst stays below the ceiling");
+  check(fabs(20 * log10(rms(out, out.size() - SAMPLE_RATE / 2) / TARGET_RMS)) <=
+            TARGET_TOLERANCE_DB,
+        "level recovers after the burst");
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,2 @@
+#pragma once
+typedef struct cJSON cJSON;
@@ -0,0 +1,16 @@
+#pragma once
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+
+// Ticks are milliseconds, enough for the tracer's dump loop in the tests.
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+static inline void vTaskDelay(TickType_t ticks) { usleep(ticks * 1000); }
+
+static inline TickType_t xTaskGetTickCount() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (TickType_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
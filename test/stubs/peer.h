@@ -0,0 +1,3 @@
+// Only the type common/main.h refers to, the host tests don't connect.
+#pragma once
+typedef struct PeerConnection PeerConnection;
@@ -0,0 +1,132 @@
+// Records events from several threads while the ring swaps of the dump run
+// concurrently, and checks that the dumps hold every event exactly once, as
+// whole records and in each thread's order. Built with ThreadSanitizer when
+// the compiler has it, which also reports a dump reading a ring that a writer
+// is still filling.
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "esp_log.h"
+
+// Every event fits into one ring, so none is overwritten between dumps
+#define TRACE_RING_EVENTS 65536
+#define WRITERS 3
+#define EVENTS_PER_WRITER 20000
+// Writers hold back until the dumps catch up, so that this many of them land
+// in between their events
+#define DUMPS 20
+
+static void on_trace_log(const char *format, ...);
+
+// The dump is printed with ESP_LOGI, read it back instead.
+#undef ESP_LOGI
+#define ESP_LOGI(tag, format, ...) on_trace_log(format, ##__VA_ARGS__)
+
+#include "trace.cpp"
+
+static int failures = 0;
+static uint32_t next_seq[WRITERS];
+static uint32_t events_read = 0;
+static uint32_t bad_records = 0;
+
+static void check(bool ok, const char *what) {
+  printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+  if (!ok) {
+    failures++;
+  }
+}
+
+static int hex_value(char c) {
+  return c >= 'a' ? c - 'a' + 10 : c - '0';
+}
+
+// Events carry the writer in the top byte of the id and in the size, and
+// the writer's sequence number in the rest of the id.
+static void read_record(const trace_record_t *record) {
+  uint32_t writer = record->id >> 24;
+  uint32_t seq = record->id & 0xffffff;
+  if (record->event != PIPECAT_TRACE_FRAME_BEGIN || writer >= WRITERS ||
+      record->size != writer || seq < next_seq[writer]) {
+    bad_records++;
+    return;
+  }
+  next_seq[writer] = seq + 1;
+  events_read++;
+}
+
+static void on_trace_log(const char *format, ...) {
+  if (strncmp(format, "TRACE EVENTS", 12) != 0) {
+    return;
+  }
+  va_list args;
+  va_start(args, format);
+  va_arg(args, int);
+  const char *line = va_arg(args, const char *);
+  va_end(args);
+
+  size_t length = strlen(line);
+  if (length % (sizeof(trace_record_t) * 2) != 0) {
+    bad_records++;
+    return;
+  }
+  for (size_t offset = 0; offset < length;
+       offset += sizeof(trace_record_t) * 2) {
+    trace_record_t record;
+    uint8_t *bytes = (uint8_t *)&record;
+    for (size_t b = 0; b < sizeof(record); b++) {
+      bytes[b] = hex_value(line[offset + b * 2]) << 4 |
+                 hex_value(line[offset + b * 2 + 1]);
+    }
+    read_record(&record);
+  }
+}
+
+TaskHandle_t pipecat_task_create(pipecat_task_t task, TaskFunction_t function,
+                                 void *arg) {
+  return NULL;
+}
+
+int main() {
+  std::atomic<int> running(WRITERS);
+  std::atomic<int> dumps(0);
+  std::vector<std::thread> writers;
+  for (uint32_t w = 0; w < WRITERS; w++) {
+    writers.emplace_back([w, &running, &dumps] {
+      for (uint32_t i = 0; i < EVENTS_PER_WRITER; i++) {
+        while (dumps < (int)(i / (EVENTS_PER_WRITER / DUMPS))) {
+          std::this_thread::yield();
+        }
+        pipecat_trace(PIPECAT_TRACE_FRAME_BEGIN, w << 24 | i, w);
+      }
+      running--;
+    });
+  }
+
+  while (running > 0) {
+    dump();
+    dumps++;
+  }
+  for (std::thread &writer : writers) {
+    writer.join();
+  }
+  // Picks up what was recorded after the last concurrent dump.
+  dump();
+
+  printf("%d dumps while %d threads recorded %d events each\n", dumps.load(),
+         WRITERS, EVENTS_PER_WRITER);
+  check(dumps >= DUMPS, "dumps ran while the writers recorded");
+  check(bad_records == 0, "every record is whole and in order");
+  check(events_read == WRITERS * EVENTS_PER_WRITER,
+        "every event is dumped exactly once");
+  for (int w = 0; w < WRITERS; w++) {
+    check(next_seq[w] == EVENTS_PER_WRITER, "no writer lost its last event");
+  }
+
+  return failures == 0 ? 0 : 1;
+}
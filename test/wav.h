@@ -0,0 +1,94 @@
+// 16-bit PCM WAV files for the host tests and tools.
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+typedef struct {
+  int sample_rate;
+  int channels;
+  // Interleaved samples
+  std::vector<int16_t> pcm;
+} wav_t;
+
+static inline uint32_t wav_le32(const uint8_t *b) {
+  return b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+static inline uint16_t wav_le16(const uint8_t *b) { return b[0] | b[1] << 8; }
+
+// Reads the fmt and data chunks, skipping any other.
+static inline bool wav_read(const char *path, wav_t *wav) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+
+  uint8_t header[12];
+  bool ok = fread(header, 1, sizeof(header), file) == sizeof(header) &&
+            memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0;
+  bool have_format = false;
+  while (ok) {
+    uint8_t chunk[8];
+    if (fread(chunk, 1, sizeof(chunk), file) != sizeof(chunk)) {
+      ok = false;
+      break;
+    }
+    uint32_t size = wav_le32(chunk + 4);
+
+    if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+      uint8_t format[16];
+      ok = fread(format, 1, sizeof(format), file) == sizeof(format) &&
+           wav_le16(format) == 1 && wav_le16(format + 14) == 16;
+      wav->channels = wav_le16(format + 2);
+      wav->sample_rate = wav_le32(format + 4);
+      have_format = true;
+      fseek(file, size - sizeof(format) + (size & 1), SEEK_CUR);
+    } else if (memcmp(chunk, "data", 4) == 0 && have_format) {
+      wav->pcm.resize(size / sizeof(int16_t));
+      ok = fread(wav->pcm.data(), sizeof(int16_t), wav->pcm.size(), file) ==
+           wav->pcm.size();
+      break;
+    } else {
+      fseek(file, size + (size & 1), SEEK_CUR);
+    }
+  }
+
+  fclose(file);
+  return ok && have_format && wav->channels > 0;
+}
+
+static inline void wav_put32(uint8_t *b, uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    b[i] = v >> (8 * i);
+  }
+}
+
+static inline bool wav_write(const char *path, const wav_t *wav) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return false;
+  }
+
+  uint32_t data_size = wav->pcm.size() * sizeof(int16_t);
+  uint32_t block_align = wav->channels * sizeof(int16_t);
+  uint8_t header[44] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V',
+                        'E', 'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0};
+  wav_put32(header + 4, 36 + data_size);
+  header[22] = wav->channels;
+  wav_put32(header + 24, wav->sample_rate);
+  wav_put32(header + 28, wav->sample_rate * block_align);
+  header[32] = block_align;
+  header[34] = 16;
+  memcpy(header + 36, "data", 4);
+  wav_put32(header + 40, data_size);
+
+  bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+            fwrite(wav->pcm.data(), sizeof(int16_t), wav->pcm.size(), file) ==
+                wav->pcm.size();
+  fclose(file);
+  return ok;
+}
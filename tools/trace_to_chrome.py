@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""Converts an EVENT_TRACE dump from a serial or Linux build log into Chrome
+trace JSON, which opens in Perfetto (https://ui.perfetto.dev) and
+chrome://tracing.
+
+    idf.py monitor | tee pipecat.log
+    python3 tools/trace_to_chrome.py pipecat.log -o trace.json
+
+The dump format is written by common/trace.cpp.
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+FORMAT_VERSION = 1
+RECORD = struct.Struct("<IBBHI")
+
+# pipecat_trace_event_t in common/main.h
+TASK_SWITCH = 0
+FRAME_BEGIN = 1
+FRAME_END = 2
+QUEUE_SEND = 3
+QUEUE_RECEIVE = 4
+QUEUE_DROP = 5
+PEER_LOOP_BEGIN = 6
+PEER_LOOP_END = 7
+DATACHANNEL_RECEIVE = 8
+DATACHANNEL_SEND = 9
+
+FRAMES = ["capture frame", "decode frame", "play frame"]
+QUEUES = ["rtvi_queue", "decode queue", "play queue"]
+
+# Process ids of the Perfetto tracks
+CPU_PID = 0
+AUDIO_PID = 1
+NETWORK_PID = 2
+# Thread ids of the tracks that aren't per core or per frame kind
+PEER_LOOP_TID = 0
+DATACHANNEL_TID = 1
+QUEUE_TID = 10
+
+ANSI_ESCAPE = re.compile(r"\x1b\[[0-9;]*m")
+TRACE_LINE = re.compile(r"TRACE (BEGIN|TASK|EVENTS|END)\s*(.*)$")
+
+
+def parse_dumps(lines):
+    """Yields (cores, task names, events per core) for every complete dump."""
+    dump = None
+    for line in lines:
+        match = TRACE_LINE.search(ANSI_ESCAPE.sub("", line).rstrip())
+        if match is None:
+            continue
+        kind, rest = match.groups()
+        if kind == "BEGIN":
+            version, cores = (int(field) for field in rest.split())
+            if version != FORMAT_VERSION:
+                sys.exit(f"Unsupported trace format {version}")
+            dump = (cores, {}, [[] for _ in range(cores)])
+        elif dump is None:
+            continue
+        elif kind == "TASK":
+            handle, _, name = rest.partition(" ")
+            dump[1][int(handle, 16)] = name
+        elif kind == "EVENTS":
+            core, data = rest.split()
+            dump[2][int(core)].extend(RECORD.iter_unpack(bytes.fromhex(data)))
+        else:
+            yield dump
+            dump = None
+
+
+def signed_delta(time_us, previous):
+    """Difference of two 32-bit timestamps, across a wrap."""
+    delta = (time_us - previous) & 0xFFFFFFFF
+    return delta - (1 << 32) if delta >= 1 << 31 else delta
+
+
+def unwrap(per_core):
+    """Gives every event a 64-bit time relative to the first event dumped."""
+    base = None
+    events = []
+    for core, records in enumerate(per_core):
+        if not records:
+            continue
+        if base is None:
+            base = records[0][0]
+        time = signed_delta(records[0][0], base)
+        previous = records[0][0]
+        for time_us, event, _, size, event_id in records:
+            time += signed_delta(time_us, previous)
+            previous = time_us
+            events.append((time, core, event, size, event_id))
+    origin = min((event[0] for event in events), default=0)
+    events = [(event[0] - origin,) + event[1:] for event in events]
+    events.sort(key=lambda event: event[0])
+    return events
+
+
+def metadata(pid, tid, process, thread):
+    return [
+        {"ph": "M", "pid": pid, "name": "process_name",
+         "args": {"name": process}},
+        {"ph": "M", "pid": pid, "tid": tid, "name": "thread_name",
+         "args": {"name": thread}},
+    ]
+
+
+def convert(cores, task_names, events):
+    trace = []
+    for core in range(cores):
+        trace += metadata(CPU_PID, core, "CPU", f"Core {core}")
+    for frame, name in enumerate(FRAMES):
+        trace += metadata(AUDIO_PID, frame, "Audio", name)
+    trace += metadata(AUDIO_PID, QUEUE_TID, "Audio", "queue drops")
+    trace += metadata(NETWORK_PID, PEER_LOOP_TID, "Network", "peer loop")
+    trace += metadata(NETWORK_PID, DATACHANNEL_TID, "Network", "data channel")
+
+    def task_name(handle):
+        return task_names.get(handle, f"task {handle:08x}")
+
+    def complete(pid, tid, name, start, end, args=None):
+        trace.append({"ph": "X", "pid": pid, "tid": tid, "name": name,
+                      "ts": start, "dur": max(end - start, 0),
+                      "args": args or {}})
+
+    running = {}
+    frames = {}
+    peer_loop = None
+    depths = [0] * len(QUEUES)
+    lowest = [0] * len(QUEUES)
+    counters = []
+
+    for time, core, event, size, event_id in events:
+        if event == TASK_SWITCH:
+            if core in running:
+                handle, start = running[core]
+                complete(CPU_PID, core, task_name(handle), start, time)
+            running[core] = (event_id, time)
+        elif event == FRAME_BEGIN:
+            frames[event_id] = (time, core, size)
+        elif event == FRAME_END and event_id in frames:
+            start, begin_core, begin_size = frames.pop(event_id)
+            complete(AUDIO_PID, event_id, FRAMES[event_id], start, time,
+                     {"core": begin_core, "bytes": begin_size})
+        elif event in (QUEUE_SEND, QUEUE_RECEIVE):
+            depths[event_id] += 1 if event == QUEUE_SEND else -1
+            lowest[event_id] = min(lowest[event_id], depths[event_id])
+            counters.append((time, event_id, depths[event_id]))
+        elif event == QUEUE_DROP:
+            trace.append({"ph": "i", "s": "g", "pid": AUDIO_PID,
+                          "tid": QUEUE_TID, "ts": time,
+                          "name": f"{QUEUES[event_id]} drop",
+                          "args": {"bytes": size, "core": core}})
+        elif event == PEER_LOOP_BEGIN:
+            peer_loop = time
+        elif event == PEER_LOOP_END and peer_loop is not None:
+            complete(NETWORK_PID, PEER_LOOP_TID, "peer_connection_loop",
+                     peer_loop, time)
+            peer_loop = None
+        elif event in (DATACHANNEL_RECEIVE, DATACHANNEL_SEND):
+            direction = "receive" if event == DATACHANNEL_RECEIVE else "send"
+            trace.append({"ph": "i", "s": "t", "pid": NETWORK_PID,
+                          "tid": DATACHANNEL_TID, "ts": time,
+                          "name": f"data channel {direction}",
+                          "args": {"bytes": size, "core": core}})
+
+    # The rings start mid-stream, so depths are relative to the emptiest
+    # point of the capture.
+    for time, queue, depth in counters:
+        trace.append({"ph": "C", "pid": AUDIO_PID, "ts": time,
+                      "name": QUEUES[queue],
+                      "args": {"depth": depth - lowest[queue]}})
+
+    return {"traceEvents": trace, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", type=argparse.FileType("r", errors="replace"),
+                        help="serial or Linux build log with a trace dump")
+    parser.add_argument("-o", "--output", default="trace.json",
+                        help="Chrome trace JSON to write")
+    parser.add_argument("-d", "--dump", type=int, default=-1,
+                        help="dump to convert, counting from 0 (default: "
+                             "the last one)")
+    args = parser.parse_args()
+
+    dumps = list(parse_dumps(args.log))
+    if not dumps:
+        sys.exit("No complete trace dump found, was EVENT_TRACE set?")
+    try:
+        cores, task_names, per_core = dumps[args.dump]
+    except IndexError:
+        sys.exit(f"The log has {len(dumps)} dumps")
+
+    events = unwrap(per_core)
+    with open(args.output, "w") as output:
+        json.dump(convert(cores, task_names, events), output)
+    print(f"{len(events)} events from dump {args.dump % len(dumps)} of "
+          f"{len(dumps)} written to {args.output}")
+
+
+if __name__ == "__main__":
+    main()